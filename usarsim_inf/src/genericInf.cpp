@@ -56,6 +56,16 @@ GenericInf::peerMsg (sw_struct * sw)
   return -1;
 }
 
+/*!
+  Tell this interface whether anyone wants the bulk data of component
+  \a name of type \a type. Interfaces that can't make use of it ignore
+  it.
+*/
+void
+GenericInf::setInterest (sw_type type, const std::string & name, int wanted)
+{
+}
+
 int
 GenericInf::msgIn (sw_struct * sw)
 {
@@ -42,6 +42,8 @@ public:
   int msgOut ();
   int msgIn (sw_struct * sw);
   virtual int peerMsg (sw_struct * sw);
+  virtual void setInterest (sw_type type, const std::string & name,
+			    int wanted);
 protected:
     ros::NodeHandle * nh;
 };
@@ -59,6 +59,55 @@ ServoInf::ServoInf ():GenericInf ()
   // set platform pointer to something to avoid core dumps
   basePlatform = &grdVehSettings;
   buildTFTree = false;
+  nh->param < bool > ("/usarsim/pointCloud", publishCloud, false);
+  ROS_DEBUG ("Parameter /usarsim/pointCloud: %d", publishCloud);
+  nh->param < bool > ("/usarsim/pointCloudSkipInvalid", cloudSkipInvalid,
+		      true);
+  ROS_DEBUG ("Parameter /usarsim/pointCloudSkipInvalid: %d",
+	     cloudSkipInvalid);
+  nh->param < double >("/usarsim/voxelLeafSize", voxelLeafSize, 0.);
+  ROS_DEBUG ("Parameter /usarsim/voxelLeafSize: %f", voxelLeafSize);
+  nh->param < bool > ("/usarsim/lazySensors", lazySensors, true);
+  ROS_DEBUG ("Parameter /usarsim/lazySensors: %d", lazySensors);
+  nh->param < bool > ("/usarsim/depthMillimetres", depthMillimetres, false);
+  ROS_DEBUG ("Parameter /usarsim/depthMillimetres: %d", depthMillimetres);
+  nh->param < bool > ("/usarsim/compressedDepth", compressDepth, false);
+  ROS_DEBUG ("Parameter /usarsim/compressedDepth: %d", compressDepth);
+  nh->param < double >("/usarsim/statsPeriod", statsPeriod, 0.);
+  double scanRate;
+  nh->param < bool > ("/usarsim/continuousScan", continuousScan, false);
+  ROS_DEBUG ("Parameter /usarsim/continuousScan: %d", continuousScan);
+  nh->param < double >("/usarsim/scanRate", scanRate, 0.);
+  ROS_DEBUG ("Parameter /usarsim/scanRate: %f", scanRate);
+  scanPeriod = scanRate > 0 ? 1. / scanRate : 0;
+  nh->param < bool > ("/usarsim/scanRoundRobin", scanRoundRobin, false);
+  ROS_DEBUG ("Parameter /usarsim/scanRoundRobin: %d", scanRoundRobin);
+  nh->param < double >("/usarsim/scanTimeout", scanTimeout, 10.);
+  ROS_DEBUG ("Parameter /usarsim/scanTimeout: %f", scanTimeout);
+  nh->param < bool > ("/usarsim/staticTf", staticTf, false);
+  ROS_DEBUG ("Parameter /usarsim/staticTf: %d", staticTf);
+  nh->param < double >("/usarsim/tfBatchDelay", tfBatchDelay, 0.02);
+  ROS_DEBUG ("Parameter /usarsim/tfBatchDelay: %f", tfBatchDelay);
+  tfBatchTime = tfBatchStart = 0;
+  tfBatchMutex = ulapi_mutex_new (SERVO_TF_KEY);
+  jointMutex = ulapi_mutex_new (SERVO_JOINT_KEY);
+  if (tfBatchMutex == NULL || jointMutex == NULL)
+  {
+    ROS_ERROR ("Unable to create tf batch mutexes, sending transforms at once");
+    tfBatchDelay = 0;
+  }
+  jointsDirty = false;
+  jointsDirtySince = 0;
+  //a tick's transforms and joints normally go out when the next tick starts
+  if (tfBatchDelay > 0)
+    tfBatchTimer = nh->createTimer (ros::Duration (tfBatchDelay / 2.),
+				    &ServoInf::tfBatchCallback, this);
+  scanMutex = ulapi_mutex_new (SERVO_SCAN_KEY);
+  if (scanMutex == NULL)
+    ROS_ERROR ("Unable to create scanMutex");
+  if (continuousScan && scanTimeout > 0)
+    scanWatchdog = nh->createTimer (ros::Duration (scanTimeout / 2.),
+				    &ServoInf::scanWatchdogCallback, this);
 }
 
 /*const UsarsimActuator*
@@ -145,8 +194,35 @@ ServoInf::init (GenericInf * usarsimIn)
   //initialize joint publisher
   jointPublisher =
     n.advertise < sensor_msgs::JointState > ("joint_states", 2);
+  joints.header.frame_id = "base_link";
+  if (jointMutex == NULL)
+  {
+    ROS_ERROR ("Unable to create jointMutex");
+    return -1;
+  }
   //add the world joint
   addJoint ("world_joint", 0.0);
+  //fixed frames are latched, so each message carries all of them
+  if (staticTf)
+    staticTfPublisher = n.advertise < tf::tfMessage > ("/tf_static", 1, true);
+
+  nh->param < bool > ("/usarsim/linkTf", publishLinkTf, false);
+  ROS_DEBUG ("Parameter /usarsim/linkTf: %d", publishLinkTf);
+  if (publishLinkTf)
+  {
+    std::string description;
+    if (!n.getParam ("robot_description", description)
+	|| kinematics.load (description) < 0)
+    {
+      ROS_ERROR ("No usable robot_description, not publishing link tf");
+      publishLinkTf = false;
+    }
+    else if (staticTf)
+    {
+      for (unsigned int i = 0; i < kinematics.fixed.size (); i++)
+	sendStaticTransform (kinematics.fixed[i]);
+    }
+  }
 
   sibling = usarsimIn;
   servoSetMutex = ulapi_mutex_new (SERVO_SET_KEY);
@@ -169,6 +245,7 @@ int
 ServoInf::peerMsg (sw_struct * sw)
 {
   int num;
+  bool changed;
   UsarsimActuator *actPtr;
   static double previousTime = 0;
   ros::Time currentTime;
@@ -180,6 +257,13 @@ ServoInf::peerMsg (sw_struct * sw)
       ("Sensor msg name %s class %s with operand %d without time (%f)",
        sw->name.c_str (), swTypeToString (sw->type), sw->op, sw->time);
   }
+  //a new simulator time ends the tick, so send what it produced
+  if (sw->time != tfBatchTime)
+  {
+    flushJoints (0);
+    flushTransforms ();
+    tfBatchTime = sw->time;
+  }
   switch (sw->type)
   {
   case SW_ACT:
@@ -251,9 +335,9 @@ ServoInf::peerMsg (sw_struct * sw)
       num = odomSensorIndex (odometers, sw->name);
       if (copyIns (&odometers[num], sw) == 1)
       {
-        rosTfBroadcaster.sendTransform (odometers[num].tf);
+        sendTransform (odometers[num].tf);
         if (odometers[num].name == odomName)
-	  rosTfBroadcaster.sendTransform (basePlatform->tf);
+	  sendTransform (basePlatform->tf);
         /*
 	  ROS_INFO("Sending transform frame: %s child: %s",
 	  odometers[num].tf.header.frame_id.c_str(),
@@ -266,7 +350,9 @@ ServoInf::peerMsg (sw_struct * sw)
 	odometers[num].odom.pose.pose.position.x,
 	odometers[num].odom.pose.pose.position.y);
       */
-      odometers[num].pub.publish (odometers[num].odom);
+      //the transform and odometry state above stay at the full rate
+      if (odometers[num].throttle.pass (ros::Time::now ().toSec ()))
+        odometers[num].pub.publish (odometers[num].odom);
       break;
     case SW_SEN_INS_SET:
       ROS_DEBUG ("Ins settings for %s: %f %f,%f,%f %f,%f,%f",
@@ -280,10 +366,10 @@ ServoInf::peerMsg (sw_struct * sw)
       num = odomSensorIndex (odometers, sw->name);
       if (copyIns (&odometers[num], sw) == 1)
       {
-        rosTfBroadcaster.sendTransform (odometers[num].tf);
+        sendTransform (odometers[num].tf);
         if (odometers[num].name == odomName)
 	{
-	  rosTfBroadcaster.sendTransform (basePlatform->tf);
+	  sendTransform (basePlatform->tf);
 	  if (!basePlatform->groundTruthSet)
 	    ROS_INFO ("Ground truth set.");
 	  basePlatform->groundTruthSet = true;
@@ -398,7 +484,7 @@ ServoInf::peerMsg (sw_struct * sw)
         // first time we know about the robot type
         if (copyGrdVehSettings (&grdVehSettings, sw) == 1)
 	{
-	  rosTfBroadcaster.sendTransform (grdVehSettings.tf);
+	  sendTransform (grdVehSettings.tf);
 	  /*
 	    ROS_INFO("Sending vehicle transform frame: %s child: %s <%f %f>",
 	    grdVehSettings.tf.header.frame_id.c_str(),
@@ -416,7 +502,7 @@ ServoInf::peerMsg (sw_struct * sw)
       }
       else
       {
-        rosTfBroadcaster.sendTransform (grdVehSettings.tf);
+        sendTransform (grdVehSettings.tf);
         /*
 	  ROS_INFO("Sending vehicle transform frame: %s child: %s <%f %f>",
 	  grdVehSettings.tf.header.frame_id.c_str(),
@@ -434,7 +520,7 @@ ServoInf::peerMsg (sw_struct * sw)
         botType = SW_ROBOT_GRD_VEH;
         if (copyGrdVehSettings (&grdVehSettings, sw) == 1)
 	{
-	  rosTfBroadcaster.sendTransform (grdVehSettings.tf);
+	  sendTransform (grdVehSettings.tf);
 	  /*
 	    ROS_INFO("Sending vehicle transform frame: %s child: %s <%f %f>",
 	    grdVehSettings.tf.header.frame_id.c_str(),
@@ -456,7 +542,7 @@ ServoInf::peerMsg (sw_struct * sw)
       }
       else
       {
-        rosTfBroadcaster.sendTransform (grdVehSettings.tf);
+        sendTransform (grdVehSettings.tf);
         /*
 	  ROS_INFO("Sending vehicle transform frame: %s child: %s <%f %f>",
 	  grdVehSettings.tf.header.frame_id.c_str(),
@@ -476,27 +562,31 @@ ServoInf::peerMsg (sw_struct * sw)
       ROS_DEBUG ("RangeScanner status for %s at time %f: ",
 		 sw->name.c_str (), sw->time);
       num = rangeSensorIndex (rangeScanners, sw->name);
-      if (copyRangeScanner (&rangeScanners[num], sw) == 1)
+      //with nobody subscribed the parser leaves the ranges out
+      if (checkInterest (&rangeScanners[num], SW_SEN_RANGESCANNER,
+			 rangeScanners[num].pub.getNumSubscribers ())
+	  && sw->data.rangescanner.number > 0
+	  && rangeScanners[num].throttle.pass (ros::Time::now ().toSec ()))
       {
-        if (!buildTFTree && rangeScanners[num].linkOffset >= 0)
+        if (copyRangeScanner (&rangeScanners[num], sw) != 1)
         {
-          publishJoints ();
-        }
-	else
-        {
-          if(!rangeScanners[num].transformSet)
-          {
-            setTransform(&rangeScanners[num], sw->data.rangescanner.mount);
-          }
-          broadcastTransform(rangeScanners[num].tf);
+          ROS_ERROR
+	    ("RangeScanner error for %s: can't copy it.",
+	     sw->name.c_str ());
+          return -1;
         }
+        rangeScanners[num].pub.publish (rangeScanners[num].scan);
+      }
+      if (!buildTFTree && rangeScanners[num].linkOffset >= 0)
+      {
+        publishJoints ();
       }
       else
       {
-        ROS_ERROR
-	  ("RangeScanner error for %s: can't copy it.",
-	   sw->name.c_str ());
-        return -1;
+        changed = !rangeScanners[num].transformSet;
+        if (changed)
+          setTransform (&rangeScanners[num], sw->data.rangescanner.mount);
+        publishMount (&rangeScanners[num], changed);
       }
       break;
 
@@ -520,11 +610,10 @@ ServoInf::peerMsg (sw_struct * sw)
       num = rangeSensorIndex (rangeScanners, sw->name);
       if (copyRangeScanner (&rangeScanners[num], sw) == 1)
       {
-        if(!rangeScanners[num].transformSet)
-        {
-          setTransform(&rangeScanners[num], sw->data.rangescanner.mount);
-        }
-        broadcastTransform(rangeScanners[num].tf);
+        changed = !rangeScanners[num].transformSet;
+        if (changed)
+          setTransform (&rangeScanners[num], sw->data.rangescanner.mount);
+        publishMount (&rangeScanners[num], changed);
       }
       else
       {
@@ -545,34 +634,37 @@ ServoInf::peerMsg (sw_struct * sw)
     {
     case SW_SEN_OBJECTSENSOR_STAT:
       num = objectSensorIndex (objectSensors, sw->name);
-      if (copyObjectSensor (&objectSensors[num], sw) == 1)
+      //with nobody subscribed the parser leaves the objects out
+      if (checkInterest (&objectSensors[num], SW_SEN_OBJECTSENSOR,
+			 objectSensors[num].pub.getNumSubscribers ())
+	  && objectSensors[num].throttle.pass (ros::Time::now ().toSec ()))
       {
-        if (!buildTFTree && objectSensors[num].linkOffset >= 0)
-        {
-          publishJoints ();
-        }
-	else
-        {
-          if(!objectSensors[num].transformSet)
-          {
-            setTransform(&objectSensors[num], sw->data.objectsensor.mount);
-          }
-          broadcastTransform(objectSensors[num].tf);
-        }
+        if (copyObjectSensor (&objectSensors[num], sw) == 1)
+          objectSensors[num].pub.publish (objectSensors[num].objSense);
+        else
+	  ROS_ERROR ("Object sensor error for %s: can't copy it.",
+		     sw->name.c_str ());
+      }
+      if (!buildTFTree && objectSensors[num].linkOffset >= 0)
+      {
+        publishJoints ();
       }
       else
-	ROS_ERROR ("Object sensor error for %s: can't copy it.",
-		   sw->name.c_str ());
+      {
+        changed = !objectSensors[num].transformSet;
+        if (changed)
+          setTransform (&objectSensors[num], sw->data.objectsensor.mount);
+        publishMount (&objectSensors[num], changed);
+      }
       break;
     case SW_SEN_OBJECTSENSOR_SET:
       num = objectSensorIndex (objectSensors, sw->name);
       if (copyObjectSensor (&objectSensors[num], sw) == 1)
       {
-	if(!objectSensors[num].transformSet)
-        {
-          setTransform(&objectSensors[num], sw->data.rangescanner.mount);
-        }
-        broadcastTransform(objectSensors[num].tf);
+        changed = !objectSensors[num].transformSet;
+        if (changed)
+          setTransform (&objectSensors[num], sw->data.objectsensor.mount);
+        publishMount (&objectSensors[num], changed);
       }
       else
 	ROS_ERROR ("Object sensor error for %s: can't copy it.",
@@ -602,11 +694,11 @@ ServoInf::peerMsg (sw_struct * sw)
         }
 	else
         {
-          if(!grippers[num].transformSet)
-          {
-            setTransform(&grippers[num], sw->data.gripper.mount, sw->data.gripper.tip);
-          }
-          broadcastTransform(grippers[num].tf);
+          changed = !grippers[num].transformSet;
+          if (changed)
+            setTransform (&grippers[num], sw->data.gripper.mount,
+			  sw->data.gripper.tip);
+          publishMount (&grippers[num], changed);
         }
         grippers[num].pub.publish (grippers[num].status);
         if (grippers[num].isActive () && grippers[num].isDone ())
@@ -625,11 +717,11 @@ ServoInf::peerMsg (sw_struct * sw)
       num = gripperEffectorIndex (grippers, sw->name);
       if (copyGripperEffector (&grippers[num], sw) == 1)
       {
-        if(!grippers[num].transformSet)
-        {
-          setTransform(&grippers[num], sw->data.gripper.mount, sw->data.gripper.tip);
-        }
-        broadcastTransform(grippers[num].tf);
+        changed = !grippers[num].transformSet;
+        if (changed)
+          setTransform (&grippers[num], sw->data.gripper.mount,
+			sw->data.gripper.tip);
+        publishMount (&grippers[num], changed);
       }
       else
       {
@@ -658,11 +750,10 @@ ServoInf::peerMsg (sw_struct * sw)
 	}
         else
         {
-          if(!toolchangers[num].transformSet)
-          {
+          changed = !toolchangers[num].transformSet;
+          if (changed)
 	    setTransform (&toolchangers[num], sw->data.toolchanger.mount);
-          }
-	  broadcastTransform (toolchangers[num].tf);
+	  publishMount (&toolchangers[num], changed);
 	}
         toolchangers[num].pub.publish (toolchangers[num].status);
       }
@@ -676,14 +767,13 @@ ServoInf::peerMsg (sw_struct * sw)
       num = toolchangerIndex (toolchangers, sw->name);
       if (copyToolchanger (&toolchangers[num], sw) == 1)
       {
-        if(!toolchangers[num].transformSet)
-		{
-		  setTransform (&toolchangers[num], sw->data.toolchanger.mount);
-		}
+        changed = !toolchangers[num].transformSet;
+        if (changed)
+	  setTransform (&toolchangers[num], sw->data.toolchanger.mount);
         if (!buildTFTree && toolchangers[num].linkOffset >= 0)
           publishJoints ();
         else
-          broadcastTransform(toolchangers[num].tf);
+          publishMount (&toolchangers[num], changed);
       }
       else
       {
@@ -701,6 +791,22 @@ ServoInf::peerMsg (sw_struct * sw)
     {
     case SW_SEN_RANGEIMAGER_STAT:
       num = rangeImagerIndex (rangeImagers, sw->name);
+      //frames the parser skipped for want of subscribers are not added
+      checkInterest (&rangeImagers[num], SW_SEN_RANGEIMAGER,
+		     rangeImagers[num].pub.getNumSubscribers ()
+		     + rangeImagers[num].cameraInfoPub.getNumSubscribers ()
+		     + rangeImagers[num].cloudPub.getNumSubscribers ()
+		     + rangeImagers[num].coarseCloudPub.getNumSubscribers ()
+		     + rangeImagers[num].compressedPub.getNumSubscribers ());
+      //a scan is kept or thinned out as a whole, decided at its first frame
+      if (sw->data.rangeimager.frame == 0)
+        rangeImagers[num].scanWanted =
+	  rangeImagers[num].throttle.pass (ros::Time::now ().toSec ());
+      //the last frame ends the scan whether or not it was assembled
+      if (continuousScan && sw->data.rangeimager.totalframes > 0
+	  && sw->data.rangeimager.frame
+	  == sw->data.rangeimager.totalframes - 1)
+        scanFinished (num);
       if (copyRangeImager (&rangeImagers[num], sw) == 1)
       {
 
@@ -710,23 +816,27 @@ ServoInf::peerMsg (sw_struct * sw)
         }
 	else
         {
-          if(!rangeImagers[num].transformSet)
-          {
-            setTransform(&rangeImagers[num], sw->data.rangeimager.mount);
-          }
-          broadcastTransform(rangeImagers[num].tf);
+          changed = !rangeImagers[num].transformSet;
+          if (changed)
+            setTransform (&rangeImagers[num], sw->data.rangeimager.mount);
+          publishMount (&rangeImagers[num], changed);
         }
-        rosTfBroadcaster.sendTransform (rangeImagers[num].opticalTransform);
+        if (!staticTf)
+          sendTransform (rangeImagers[num].opticalTransform);
         //since virtual range imaging is slow, wait for a full scan before publishing the camera info and depth image
-        if (rangeImagers[num].isReady ())
+        if (rangeImagers[num].hasImage ())
 	{
-	  rangeImagers[num].depthImage.header.stamp = currentTime;
+	  sensor_msgs::Image & depthImage =
+	    rangeImagers[num].depth.completed ();
+	  depthImage.header.stamp = currentTime;
+	  depthImage.header.frame_id = rangeImagers[num].opticalFrame;
 	  rangeImagers[num].camInfo.header.stamp = currentTime;
 	  //camera info and depth image need to be published in sync
-	  rangeImagers[num].pub.
-	    publish (rangeImagers[num].depthImage);
+	  publishRangeImagerDepth (&rangeImagers[num], sw);
 	  rangeImagers[num].cameraInfoPub.
 	    publish (rangeImagers[num].camInfo);
+	  if (publishCloud || voxelLeafSize > 0)
+	    publishRangeImagerCloud (&rangeImagers[num], sw);
 
 	}
       }
@@ -740,13 +850,12 @@ ServoInf::peerMsg (sw_struct * sw)
       num = rangeImagerIndex (rangeImagers, sw->name);
       if (copyRangeImager (&rangeImagers[num], sw) == 1)
       {
-        if(!rangeImagers[num].transformSet)
-        {
-          setTransform(&rangeImagers[num], sw->data.rangeimager.mount);
-        }
-        broadcastTransform(rangeImagers[num].tf);
-        rosTfBroadcaster.
-	  sendTransform (rangeImagers[num].opticalTransform);
+        changed = !rangeImagers[num].transformSet;
+        if (changed)
+          setTransform (&rangeImagers[num], sw->data.rangeimager.mount);
+        publishMount (&rangeImagers[num], changed);
+        if (!staticTf)
+          sendTransform (rangeImagers[num].opticalTransform);
       }
       else
       {
@@ -800,82 +909,111 @@ ServoInf::~ServoInf ()
     ulapi_mutex_delete (servoSetMutex);
     servoSetMutex = NULL;
   }
+  if (tfBatchMutex != NULL)
+  {
+    ulapi_mutex_delete (tfBatchMutex);
+    tfBatchMutex = NULL;
+  }
+  if (jointMutex != NULL)
+  {
+    ulapi_mutex_delete (jointMutex);
+    jointMutex = NULL;
+  }
+  if (scanMutex != NULL)
+  {
+    ulapi_mutex_delete (scanMutex);
+    scanMutex = NULL;
+  }
 }
 
 int
 ServoInf::copyActuator (UsarsimActuator * act, const sw_struct * sw)
 {
-  ros::Time currentTime;
-
-  std::stringstream tempSS;
-
-  currentTime = ros::Time::now ();
   act->numJoints = sw->data.actuator.number;
 
-  //define the mounting joint for this actuator
-  addJoint (act->name + "_mount", 0.0);
-  act->minValues.clear ();
-  act->maxValues.clear ();
-  act->maxTorques.clear ();
-  act->jointTypes.clear ();
-
-  //create actuator joints
-  for (int i = 0; i < sw->data.actuator.number; i++)
-  {
-    tempSS.str ("");
-    tempSS << i + 1;
+  //the chain only changes with the CONF/GEO data, so status messages reuse it
+  if (sw->op == SW_ACT_SET
+      || act->jointTf.size () != (unsigned int) act->numJoints + 1)
+    compileActuatorChain (act, sw);
 
-    addJoint (act->name + std::string ("_joint_") + tempSS.str (),
-        sw->data.actuator.link[i].position);
-
-    act->minValues.push_back (sw->data.actuator.link[i].minvalue);
-    act->maxValues.push_back (sw->data.actuator.link[i].maxvalue);
-    act->maxTorques.push_back (sw->data.actuator.link[i].maxtorque);
-    act->jointTypes.push_back (sw->data.actuator.link[i].type);
-  }
+  //update actuator joints in place
+  ulapi_mutex_take (jointMutex);
+  for (int i = 0; i < act->numJoints; i++)
+    joints.position[act->jointIndices[i]] = sw->data.actuator.link[i].position;
+  ulapi_mutex_give (jointMutex);
     
   //ROS_ERROR( "CopyAct success!!" );
   return 1;
 }
 
-int
-ServoInf::updateActuatorTF (UsarsimActuator * act, const sw_struct * sw,
-          bool broadcastTF)
+/*
+  Work out everything about an actuator that doesn't change from one
+  status message to the next: its joint and frame names, the limits of
+  each link, and the fixed transforms from link to link and out to the
+  tip. Status messages then only update the joint values.
+*/
+void
+ServoInf::compileActuatorChain (UsarsimActuator * act, const sw_struct * sw)
 {
-  ros::Time currentTime;
   tf::Quaternion quat;
-  geometry_msgs::Quaternion quatMsg;
   geometry_msgs::TransformStamped currentJointTf;
   std::stringstream tempSS;
   tf::Transform currentTipTransform;  //relative to actuator base
   tf::Transform lastTipTransform;  //relative to actuator base
   tf::Transform absoluteTransform;  //relative to actuator base
+  int n = act->numJoints;
 
-  currentTime = ros::Time::now ();
-  act->jointTf.clear ();
-  act->jointAxes.clear ();
-  currentJointTf.header.stamp = currentTime;
+  //define the mounting joint for this actuator
+  addJoint (act->name + "_mount", 0.0);
+  act->jointNames.resize (n);
+  act->jointIndices.resize (n);
+  act->linkFrames.resize (n + 1);
+  for (int i = 0; i <= n; i++)
+  {
+    tempSS.str ("");
+    tempSS << i;
+    act->linkFrames[i] = act->name + "_link" + tempSS.str ();
+    if (i > 0)
+    {
+      act->jointNames[i - 1] = act->name + "_joint_" + tempSS.str ();
+      act->jointIndices[i - 1] = addJoint (act->jointNames[i - 1], 0.0);
+    }
+  }
 
-  setTransform (act, sw->data.actuator.mount);
-  act->tf.child_frame_id = act->name + "_link0";
-  if (broadcastTF)
-    broadcastTransform(act->tf);
+  //link parameters, one array per field
+  act->linkParents.resize (n);
+  act->minValues.resize (n);
+  act->maxValues.resize (n);
+  act->maxTorques.resize (n);
+  act->jointTypes.resize (n);
+  for (int i = 0; i < n; i++)
+  {
+    act->linkParents[i] = sw->data.actuator.link[i].parent;
+    if (act->linkParents[i] < 0 || act->linkParents[i] > n)
+    {
+      ROS_WARN ("%s link %d has invalid parent %d, using the base",
+		act->name.c_str (), i + 1, act->linkParents[i]);
+      act->linkParents[i] = 0;
+    }
+    act->minValues[i] = sw->data.actuator.link[i].minvalue;
+    act->maxValues[i] = sw->data.actuator.link[i].maxvalue;
+    act->maxTorques[i] = sw->data.actuator.link[i].maxtorque;
+    act->jointTypes[i] = sw->data.actuator.link[i].type;
+  }
 
+  act->jointTf.clear ();
+  act->jointAxes.clear ();
+  act->jointTf.reserve (n + 1);
+  act->jointAxes.reserve (n);
   lastTipTransform.setIdentity();
   currentTipTransform.setIdentity();
   absoluteTransform.setIdentity();
-  for (int i = 0; i < act->numJoints; i++)
+  for (int i = 0; i < n; i++)
   {
-    tempSS.str ("");
-    tempSS << i + 1;
-    currentJointTf.child_frame_id =
-      act->name + std::string ("_link") + tempSS.str ();
-    tempSS.str ("");
-    tempSS << sw->data.actuator.link[i].parent;
+    currentJointTf.child_frame_id = act->linkFrames[i + 1];
     tf::Transform relativeTransform; //relative to previous link
     relativeTransform.setIdentity();
-    currentJointTf.header.frame_id =
-      act->name + std::string ("_link") + tempSS.str ();
+    currentJointTf.header.frame_id = act->linkFrames[act->linkParents[i]];
     //USARSim specifies link offsets in actuator coordinates and link rotations in link coordinates,
     //so we need to treat rotations and positions seperately when calculating link transforms.
     quat =
@@ -920,24 +1058,12 @@ ServoInf::updateActuatorTF (UsarsimActuator * act, const sw_struct * sw,
 
     tf::transformTFToMsg (relativeTransform, currentJointTf.transform);
     act->jointTf.push_back (currentJointTf);
-    if (broadcastTF)
-      rosTfBroadcaster.sendTransform (currentJointTf);
   }
   //add transformation for arm tip
   //arm tip ALWAYS uses standard joint coordinate frame (positive z-axis towards tip)
-  if (!act->jointTf.empty ())
-  {
-    currentJointTf.header.frame_id = act->jointTf.back ().child_frame_id;
-  }
-  else
-  {
-    currentJointTf.header.frame_id = act->name + "_link0";
-  }
+  currentJointTf.header.frame_id = act->linkFrames[n];
   currentJointTf.child_frame_id = act->name + "_tip";
 
-  //  ROS_INFO( "Setting tip transform child: %s and parent: %s", currentJointTf.child_frame_id.c_str(),
-  //      currentJointTf.header.frame_id.c_str() );
-
   tf::Vector3 tipOffset (sw->data.actuator.tip.x, sw->data.actuator.tip.y,
        sw->data.actuator.tip.z);
 
@@ -962,10 +1088,62 @@ ServoInf::updateActuatorTF (UsarsimActuator * act, const sw_struct * sw,
     lastTipTransform.inverseTimes (absoluteTransform);
 
   tf::transformTFToMsg (relativeTransform, currentJointTf.transform);
+  act->jointTf.push_back (currentJointTf);
+  act->chainChanged = true;
+}
+
+/*
+  Publish the transforms of a compiled actuator chain. Only the stamps
+  change from one status message to the next; with static tf the links
+  are latched when the chain changes and not sent again.
+*/
+int
+ServoInf::updateActuatorTF (UsarsimActuator * act, const sw_struct * sw,
+          bool broadcastTF)
+{
+  ros::Time currentTime;
+  bool changed = act->chainChanged;
+  bool mountChanged = false;
+  //links only ever move through joints when building the tree
+  bool fixed = staticTf && buildTFTree;
+  int n = act->numJoints;
+
+  act->chainChanged = false;
+  if (changed || !act->transformSet)
+  {
+    setTransform (act, sw->data.actuator.mount);
+    act->tf.child_frame_id = act->linkFrames[0];
+    mountChanged = act->transformSet;
+  }
+
+  currentTime = ros::Time::now ();
+  if (broadcastTF)
+  {
+    if (fixed)
+      publishMount (act, mountChanged);
+    else
+      broadcastTransform (act->tf);
+    for (int i = 0; i < n && (changed || !fixed); i++)
+    {
+      if (fixed)
+	sendStaticTransform (act->jointTf[i]);
+      else
+      {
+	act->jointTf[i].header.stamp = currentTime;
+	sendTransform (act->jointTf[i]);
+      }
+    }
+  }
 
   //tip transformation has no joint or link, so always publish it
-  rosTfBroadcaster.sendTransform (currentJointTf);
-  act->jointTf.push_back (currentJointTf);
+  geometry_msgs::TransformStamped & tipTf = act->jointTf[n];
+  if (!staticTf)
+  {
+    tipTf.header.stamp = currentTime;
+    sendTransform (tipTf);
+  }
+  else if (changed)
+    sendStaticTransform (tipTf);
 
   return 1;
 }
@@ -1130,91 +1308,223 @@ ServoInf::copyRangeScanner (UsarsimRngScnSensor * sen, const sw_struct * sw)
   currentTime = ros::Time::now ();
 
   sen->scan.header.stamp = currentTime;
-  //  sen->scan.header.frame_id = sen->tf.header.frame_id;
-  sen->scan.header.frame_id = sen->name;
-  sen->scan.angle_min = -sw->data.rangescanner.fov / 2.;
-  sen->scan.angle_max = sw->data.rangescanner.fov / 2.;
-  sen->scan.angle_increment = sw->data.rangescanner.resolution;
-  sen->scan.time_increment = 0;  // (1 / laser_frequency) / (num_readings);
-  sen->scan.range_min = sw->data.rangescanner.minrange;
-  sen->scan.range_max = sw->data.rangescanner.maxrange;
-
-  //  sen->scan.set_ranges_size((unsigned int)sw->data.rangescanner.number);
-  //  sen->scan.set_intensities_size((unsigned int)0);
-  sen->scan.ranges.clear ();
+  //the rest of the header only changes with the settings
+  if (sw->op == SW_SEN_RANGESCANNER_SET
+      || sen->fov != sw->data.rangescanner.fov
+      || sen->resolution != sw->data.rangescanner.resolution)
+  {
+    sen->fov = sw->data.rangescanner.fov;
+    sen->resolution = sw->data.rangescanner.resolution;
+    sen->scan.angle_min = -sen->fov / 2.;
+    sen->scan.angle_max = sen->fov / 2.;
+    sen->scan.angle_increment = sen->resolution;
+    sen->scan.time_increment = 0;  // (1 / laser_frequency) / (num_readings);
+    sen->scan.range_min = sw->data.rangescanner.minrange;
+    sen->scan.range_max = sw->data.rangescanner.maxrange;
+  }
+
+  //resize keeps the vector's storage, so only a bigger scan than any
+  //before it allocates
+  int number = sw->data.rangescanner.number;
+  sen->scan.ranges.resize (number);
   sen->scan.intensities.clear ();
+  if (number <= 0)
+    return 1;
+  const float *src = sw->data.rangescanner.range;
+  float *dst = &sen->scan.ranges[0];
   if (flipScanner)
   {
-    for (int i = sw->data.rangescanner.number - 1; i >= 0; i--)
-    {
-      sen->scan.ranges.push_back (sw->data.rangescanner.range[i]);
-    }
+    for (int i = 0; i < number; i++)
+      dst[i] = src[number - 1 - i];
   }
   else
-  {
-    for (int i = 0; i < sw->data.rangescanner.number; i++)
-    {
-      sen->scan.ranges.push_back (sw->data.rangescanner.range[i]);
-    }
-  }
+    std::copy (src, src + number, dst);
   return 1;
 }
 
 int
 ServoInf::copyObjectSensor (UsarsimObjectSensor * sen, const sw_struct * sw)
 {
-  ros::Time currentTime;
   tf::Quaternion quat;
-  geometry_msgs::Quaternion quatMsg;
+  int number = sw->data.objectsensor.number;
 
-  sen->objSense.header.stamp = currentTime;
-  sen->objSense.header.frame_id = sen->name;
+  sen->objSense.header.stamp = ros::Time::now ();
   sen->objSense.fov = sw->data.objectsensor.fov;
-  sen->objSense.object_names.clear ();
-  sen->objSense.material_names.clear ();
-  sen->objSense.object_poses.clear ();
-  sen->objSense.object_hit_locations.clear ();
-  for (int i = 0; i < sw->data.objectsensor.number; i++)
+  //resize keeps each vector's storage from the last report, and the
+  //names are assigned over the old ones
+  if (number < 0)
+    number = 0;
+  sen->objSense.object_names.resize (number);
+  sen->objSense.material_names.resize (number);
+  sen->objSense.object_poses.resize (number);
+  sen->objSense.object_hit_locations.resize (number);
+  for (int i = 0; i < number; i++)
   {
-    sen->objSense.
-      object_names.push_back (std::
-            string (sw->data.objectsensor.objects[i].
-              tag));
-    sen->objSense.
-      material_names.push_back (std::string
-        (sw->data.objectsensor.objects[i].
-         material_name));
-    geometry_msgs::Pose objectPose;
-    geometry_msgs::Pose objectHitLocation;
-
-    objectPose.position.x = sw->data.objectsensor.objects[i].position.x;
-    objectPose.position.y = sw->data.objectsensor.objects[i].position.y;
-    objectPose.position.z = sw->data.objectsensor.objects[i].position.z;
-
-    objectHitLocation.position.x =
-      sw->data.objectsensor.objects[i].hit_location.x;
-    objectHitLocation.position.y =
-      sw->data.objectsensor.objects[i].hit_location.y;
-    objectHitLocation.position.z =
-      sw->data.objectsensor.objects[i].hit_location.z;
+    const sw_sen_object_struct & object = sw->data.objectsensor.objects[i];
+    geometry_msgs::Pose & objectPose = sen->objSense.object_poses[i];
+    geometry_msgs::Pose & objectHitLocation =
+      sen->objSense.object_hit_locations[i];
+
+    sen->objSense.object_names[i] = *object.tag;
+    sen->objSense.material_names[i] = *object.material_name;
+
+    objectPose.position.x = object.position.x;
+    objectPose.position.y = object.position.y;
+    objectPose.position.z = object.position.z;
+    quat = tf::createQuaternionFromRPY (object.position.roll,
+					object.position.pitch,
+					object.position.yaw);
+    tf::quaternionTFToMsg (quat, objectPose.orientation);
+
+    objectHitLocation.position.x = object.hit_location.x;
+    objectHitLocation.position.y = object.hit_location.y;
+    objectHitLocation.position.z = object.hit_location.z;
+  }
 
-    quat =
-      tf::createQuaternionFromRPY (sw->data.objectsensor.
-           objects[i].position.roll,
-           sw->data.objectsensor.
-           objects[i].position.pitch,
-           sw->data.objectsensor.
-           objects[i].position.yaw);
+  return 1;
+}
 
-    tf::quaternionTFToMsg (quat, quatMsg);
-    objectPose.orientation = quatMsg;
+/*
+  Tell the parser when the number of subscribers to \a sen, \a listeners
+  over all of its topics, drops to or rises from none, so that it can
+  skip the bulk of the sensor's messages while nobody is listening.
+  \return whether the sensor's data should be copied and published.
+*/
+bool
+ServoInf::checkInterest (UsarsimSensor * sen, sw_type type,
+			 unsigned int listeners)
+{
+  bool wanted = listeners > 0 || !lazySensors;
 
-    sen->objSense.object_hit_locations.push_back (objectHitLocation);
-    sen->objSense.object_poses.push_back (objectPose);
+  if (wanted != sen->wanted)
+  {
+    ROS_DEBUG ("%s now has %u subscribers", sen->name.c_str (), listeners);
+    sen->wanted = wanted;
+    sibling->setInterest (type, sen->name, wanted);
+  }
+  return wanted;
+}
 
+/*
+  Deproject the scan that just completed straight into a point cloud,
+  in place of running depth_image_proc on the depth image, and
+  downsample it in place of a voxel grid nodelet. The full cloud is
+  only built when one of them has subscribers.
+*/
+void
+ServoInf::publishRangeImagerCloud (UsarsimRngImgSensor * sen,
+				   const sw_struct * sw)
+{
+  sensor_msgs::Image & depthImage = sen->depth.completed ();
+  bool full = publishCloud && sen->cloudPub.getNumSubscribers () > 0;
+  bool coarse = voxelLeafSize > 0
+    && sen->coarseCloudPub.getNumSubscribers () > 0;
+
+  if (!full && !coarse)
+    return;
+  sen->cloudMaker.setRays (depthImage.width, depthImage.height,
+			   sw->data.rangeimager.fovx,
+			   sw->data.rangeimager.fovy);
+  if (sen->cloudMaker.build (depthImage, sw->data.rangeimager.minrange,
+			     sw->data.rangeimager.maxrange,
+			     cloudSkipInvalid, sen->cloud) < 0)
+  {
+    ROS_WARN ("Range imager %s: can't make a point cloud from a %dx%d "
+	      "image", sen->name.c_str (), depthImage.width,
+	      depthImage.height);
+    return;
   }
+  if (full)
+    sen->cloudPub.publish (sen->cloud);
+  if (coarse && sen->voxels.filter (sen->cloud, sen->coarseCloud) >= 0)
+    sen->coarseCloudPub.publish (sen->coarseCloud);
+}
 
-  return 1;
+/*
+  In continuous mode, ask for the next scan now that range imager
+  \a num has sent its last frame: from the same imager, or from the
+  next one in round robin mode. A request is held back until scanPeriod
+  has passed since the one before it.
+*/
+void
+ServoInf::scanFinished (unsigned int num)
+{
+  UsarsimRngImgSensor *next;
+  double delay;
+
+  ulapi_mutex_take (scanMutex);
+  delay = rangeImagers[num].scanRequested + scanPeriod
+    - ros::Time::now ().toSec ();
+  rangeImagers[num].scanRequested = 0;
+  if (scanRoundRobin)
+    num = (num + 1) % rangeImagers.size ();
+  next = &rangeImagers[num];
+  ulapi_mutex_give (scanMutex);
+  if (delay <= 0)
+    next->requestScan ();
+  else
+    next->scanTimer =
+      nh->createTimer (ros::Duration (delay),
+		       &UsarsimRngImgSensor::scanTimerCallback, next, true);
+}
+
+/*
+  Scans whose last frame never arrives would stop continuous scanning,
+  so ask again for any that are overdue.
+*/
+void
+ServoInf::scanWatchdogCallback (const ros::TimerEvent & event)
+{
+  std::vector < UsarsimRngImgSensor * >overdue;
+  double now = ros::Time::now ().toSec ();
+
+  // imagers are added from the publish thread, so only look under the lock
+  ulapi_mutex_take (scanMutex);
+  for (unsigned int i = 0; i < rangeImagers.size (); i++)
+  {
+    if (rangeImagers[i].scanRequested > 0
+	&& now - rangeImagers[i].scanRequested > scanTimeout)
+      overdue.push_back (&rangeImagers[i]);
+  }
+  ulapi_mutex_give (scanMutex);
+  for (unsigned int i = 0; i < overdue.size (); i++)
+  {
+    ROS_WARN ("Range imager %s: scan not finished after %.1f s, "
+	      "asking again", overdue[i]->name.c_str (), scanTimeout);
+    overdue[i]->requestScan ();
+  }
+}
+
+/*
+  Publish the scan that just completed as 32FC1 metres, or 16UC1
+  millimetres if asked for, and compressed if anyone wants that.
+*/
+void
+ServoInf::publishRangeImagerDepth (UsarsimRngImgSensor * sen,
+				   const sw_struct * sw)
+{
+  sensor_msgs::Image & depthImage = sen->depth.completed ();
+  bool compress = compressDepth
+    && sen->compressedPub.getNumSubscribers () > 0;
+
+  if (!depthMillimetres && !compress)
+  {
+    sen->pub.publish (depthImage);
+    return;
+  }
+  if (sen->depthCodec.toMillimetres (depthImage,
+				     sw->data.rangeimager.minrange,
+				     sw->data.rangeimager.maxrange,
+				     sen->depth16) < 0)
+  {
+    ROS_WARN ("Range imager %s: can't convert a %s image to millimetres",
+	      sen->name.c_str (), depthImage.encoding.c_str ());
+    return;
+  }
+  sen->pub.publish (depthMillimetres ? sen->depth16 : depthImage);
+  if (compress && sen->depthCodec.compress (sen->depth16, sen->compressedDepth) >= 0)
+    sen->compressedPub.publish (sen->compressedDepth);
+  sen->depthCodec.updateStats (sen->name);
 }
 
 int
@@ -1222,68 +1532,16 @@ ServoInf::copyRangeImager (UsarsimRngImgSensor * sen, const sw_struct * sw)
 {
   ros::Time currentTime = ros::Time::now ();
   sen->opticalTransform.header.stamp = currentTime;
-  sen->depthImage.header.stamp = currentTime;
-  sen->depthImage.header.frame_id = sen->name + "_optical";
-
   sen->totalFrames = sw->data.rangeimager.totalframes;
-  sen->depthImage.encoding = sensor_msgs::image_encodings::TYPE_32FC1;
-  if (sen->totalFrames != 0)
+  if (sen->totalFrames != 0 && sw->op == SW_SEN_RANGEIMAGER_STAT)
   {
-    //insert the current frame into a depth image
-    sen->sentFrame (sw->data.rangeimager.frame);
-    sen->depthImage.height = sw->data.rangeimager.resolutiony;
-    sen->depthImage.width = sw->data.rangeimager.resolutionx;
-    sen->depthImage.step =
-      sizeof (float) * sw->data.rangeimager.resolutionx;
-    sen->depthImage.data.reserve (sen->depthImage.step *
-          sen->depthImage.height);
-    sen->depthImage.data.insert (sen->depthImage.data.begin () +
-         (sw->data.rangeimager.frame *
-          sw->data.rangeimager.numberperframe *
-          sizeof (float)),
-         reinterpret_cast <
-         const uint8_t *
-         >(sw->data.rangeimager.range),
-         reinterpret_cast <
-         const uint8_t *
-         >(sw->data.rangeimager.range +
-           sw->data.rangeimager.numberperframe));
+    //copy the current frame into the depth image
+    sen->sentFrame (sw->data.rangeimager);
   }
-  //camera calibration data from the Kinect. 
-  //This will be scaled incorrectly if the camera's FOV is not the same as the Kinect's! (58x45 degrees)
-  sen->camInfo.header.frame_id = "/" + sen->name + "_optical";
-  sen->camInfo.height = sw->data.rangeimager.resolutiony;
-  sen->camInfo.width = sw->data.rangeimager.resolutionx;
-  float xScale = (float) sen->camInfo.width / 640.0;
-  float yScale = (float) sen->camInfo.height / 480.0;
-  sen->camInfo.distortion_model = "plumb_bob";
-  double dArray[] =
-    { 0.00000000, 0.00000000, 0.00000000, 0.00000000, 0.00000000 };
-  double kArray[] =
-    { 585.05108211 * xScale, 0.00000000, 315.83800193 * xScale, 0.00000000,
-      585.05108211 * yScale, 242.94140713 * yScale, 0.00000000, 0.00000000,
-      1.00000000
-    };
-  double rArray[] = { 1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
-  double pArray[] =
-    { 585.05108211 * xScale, 0.00000000, 315.83800193 * xScale, 0.0,
-      0.00000000, 585.05108211 * yScale, 242.94140713 * yScale, 0.0, 0.00000000,
-      0.00000000,
-      1.00000000, 0.0
-    };
-
-
-  sen->camInfo.D.assign (dArray, dArray + 5);
-  std::copy (kArray, kArray + 9, sen->camInfo.K.begin ());
-  std::copy (rArray, rArray + 9, sen->camInfo.R.begin ());
-  std::copy (pArray, pArray + 12, sen->camInfo.P.begin ());
-  sen->camInfo.binning_x = 0;
-  sen->camInfo.binning_y = 0;
-  sen->camInfo.roi.x_offset = 0;
-  sen->camInfo.roi.y_offset = 0;
-  sen->camInfo.roi.height = 0;
-  sen->camInfo.roi.width = 0;
-  sen->camInfo.roi.do_rectify = false;
+  //the intrinsics only change with the resolution or field of view
+  sen->setIntrinsics (sw->data.rangeimager.resolutionx,
+		      sw->data.rangeimager.resolutiony,
+		      sw->data.rangeimager.fovx, sw->data.rangeimager.fovy);
   return 1;
 }
 
@@ -1420,12 +1678,17 @@ ServoInf::setTransform (UsarsimSensor * sen, const sw_pose & pose)
       addJoint (sen->name + "_mount", 0.0);
     }
     bool success = false;
-    //get the transformation from the robot frame to this item's direct parent
+    //get the transformation from the robot frame to this item's direct parent,
+    //asking first so that a parent not yet known costs no exception
     try
     {
-      tfListener.lookupTransform ("base_link", sen->tf.header.frame_id,
-          ros::Time (0), parentTransform);
-      success = true;
+      if (tfListener.canTransform ("base_link", sen->tf.header.frame_id,
+				   ros::Time (0)))
+      {
+	tfListener.lookupTransform ("base_link", sen->tf.header.frame_id,
+				    ros::Time (0), parentTransform);
+	success = true;
+      }
     }
     catch (tf::LookupException e)
     {
@@ -1489,7 +1752,108 @@ void
 ServoInf::broadcastTransform(geometry_msgs::TransformStamped &tf)
 {
   tf.header.stamp = ros::Time::now();
-  rosTfBroadcaster.sendTransform (tf);
+  sendTransform (tf);
+}
+
+/*
+  Queue a transform to go out with the rest of the current simulator
+  tick as one tf message. A batch is sent early if it has been waiting
+  longer than the batching delay; with no delay the transform is sent
+  at once.
+*/
+void
+ServoInf::sendTransform (const geometry_msgs::TransformStamped & tf)
+{
+  double now;
+
+  if (tfBatchDelay <= 0)
+  {
+    rosTfBroadcaster.sendTransform (tf);
+    return;
+  }
+  now = ulapi_time ();
+  ulapi_mutex_take (tfBatchMutex);
+  if (tfBatch.empty ())
+    tfBatchStart = now;
+  tfBatch.push_back (tf);
+  if (now - tfBatchStart >= tfBatchDelay)
+  {
+    rosTfBroadcaster.sendTransform (tfBatch);
+    tfBatch.clear ();
+  }
+  ulapi_mutex_give (tfBatchMutex);
+}
+
+/*
+  Send the transforms queued so far. The batch keeps its memory for the
+  next tick.
+*/
+void
+ServoInf::flushTransforms ()
+{
+  if (tfBatchDelay <= 0)
+    return;
+  ulapi_mutex_take (tfBatchMutex);
+  if (!tfBatch.empty ())
+  {
+    rosTfBroadcaster.sendTransform (tfBatch);
+    tfBatch.clear ();
+  }
+  ulapi_mutex_give (tfBatchMutex);
+}
+
+/*
+  Send joint states and a batch of transforms that have waited out the
+  batching delay, for when no new tick comes along to end them.
+*/
+void
+ServoInf::tfBatchCallback (const ros::TimerEvent & event)
+{
+  flushJoints (tfBatchDelay);
+  ulapi_mutex_take (tfBatchMutex);
+  if (!tfBatch.empty () && ulapi_time () - tfBatchStart >= tfBatchDelay)
+  {
+    rosTfBroadcaster.sendTransform (tfBatch);
+    tfBatch.clear ();
+  }
+  ulapi_mutex_give (tfBatchMutex);
+}
+
+/*
+  Add a fixed frame to the latched /tf_static message, replacing any
+  earlier transform for the same child, and publish the whole set.
+*/
+void
+ServoInf::sendStaticTransform (geometry_msgs::TransformStamped & tf)
+{
+  unsigned int i;
+
+  tf.header.stamp = ros::Time::now ();
+  for (i = 0; i < staticTransforms.transforms.size (); i++)
+  {
+    if (staticTransforms.transforms[i].child_frame_id == tf.child_frame_id)
+      break;
+  }
+  if (i == staticTransforms.transforms.size ())
+    staticTransforms.transforms.push_back (tf);
+  else
+    staticTransforms.transforms[i] = tf;
+  staticTfPublisher.publish (staticTransforms);
+}
+
+/*
+  Publish the mount of a component. Once setTransform has worked it out
+  the mount is fixed, so with static tf it goes out on /tf_static when
+  it has just \a changed and not again. Until then, or without static
+  tf, it is broadcast every time.
+*/
+void
+ServoInf::publishMount (UsarsimSensor * sen, bool changed)
+{
+  if (!staticTf || !sen->transformSet)
+    broadcastTransform (sen->tf);
+  else if (changed)
+    sendStaticTransform (sen->tf);
 }
 
 /*
@@ -1558,6 +1922,7 @@ ServoInf::odomSensorIndex (std::vector < UsarsimOdomSensor > &sensors,
   newSensor.pub = nh->advertise < nav_msgs::Odometry > (pubName.c_str (), 2);
   newSensor.tf.header.frame_id = "base_link";
   newSensor.tf.child_frame_id = newSensor.name.c_str ();
+  setThrottle (&newSensor);
 
 
   sensors.push_back (newSensor);
@@ -1583,8 +1948,11 @@ ServoInf::rangeSensorIndex (std::vector < UsarsimRngScnSensor > &sensors,
   newSensor.name = name;
   newSensor.time = 0;
   newSensor.pub = nh->advertise < sensor_msgs::LaserScan > (name.c_str (), 2);
+  //  newSensor.scan.header.frame_id = newSensor.tf.header.frame_id;
+  newSensor.scan.header.frame_id = name;
   newSensor.tf.header.frame_id = "base_link";
   newSensor.tf.child_frame_id = name.c_str ();
+  setThrottle (&newSensor);
 
   sensors.push_back (newSensor);
   return sensors.size () - 1;
@@ -1608,15 +1976,37 @@ ServoInf::objectSensorIndex (std::vector < UsarsimObjectSensor > &sensors,
   newSensor.time = 0;
   newSensor.pub =
     nh->advertise < usarsim_inf::SenseObject > (name.c_str (), 2);
+  newSensor.objSense.header.frame_id = name;
   newSensor.tf.header.frame_id = "base_link";
   newSensor.tf.child_frame_id = name.c_str ();
+  setThrottle (&newSensor);
 
   sensors.push_back (newSensor);
   return sensors.size () - 1;
 }
 
+/*
+  Set up the throttle for \a sen from /usarsim/sensors/<name>/max_rate,
+  in messages a second, and /usarsim/sensors/<name>/decimation. Range
+  imagers are throttled by whole scans.
+*/
+void
+ServoInf::setThrottle (UsarsimSensor * sen)
+{
+  std::string prefix = "/usarsim/sensors/" + sen->name + "/";
+  double maxRate;
+  int decimation;
+
+  nh->param < double >(prefix + "max_rate", maxRate, 0);
+  nh->param < int >(prefix + "decimation", decimation, 1);
+  if (maxRate > 0 || decimation > 1)
+    ROS_INFO ("Throttling %s to every %d messages, at most %g per second",
+	      sen->name.c_str (), decimation, maxRate);
+  sen->throttle.set (maxRate, decimation);
+}
+
 int
-ServoInf::rangeImagerIndex (std::vector < UsarsimRngImgSensor > &sensors,
+ServoInf::rangeImagerIndex (std::deque < UsarsimRngImgSensor > &sensors,
           std::string name)
 {
   unsigned int t;
@@ -1627,7 +2017,11 @@ ServoInf::rangeImagerIndex (std::vector < UsarsimRngImgSensor > &sensors,
   }
   ROS_INFO ("Adding sensor: %s", name.c_str ());
   UsarsimRngImgSensor newSensor (this);
+  newSensor.scanMutex = scanMutex;
+  newSensor.continuous = continuousScan;
+  ulapi_mutex_take (scanMutex);
   sensors.push_back (newSensor);
+  ulapi_mutex_give (scanMutex);
   UsarsimRngImgSensor *sensePtr = &(sensors.back ());
   sensePtr->name = name;
   sensePtr->time = 0;
@@ -1639,14 +2033,35 @@ ServoInf::rangeImagerIndex (std::vector < UsarsimRngImgSensor > &sensors,
        &UsarsimRngImgSensor::commandCallback, sensePtr);
   sensePtr->cameraInfoPub =
     nh->advertise < sensor_msgs::CameraInfo > ("camera_info", 2);
+  if (publishCloud)
+    sensePtr->cloudPub =
+      nh->advertise < sensor_msgs::PointCloud2 > ("points", 2);
+  if (voxelLeafSize > 0)
+  {
+    sensePtr->coarseCloudPub =
+      nh->advertise < sensor_msgs::PointCloud2 > ("points_downsampled", 2);
+    sensePtr->voxels.setLeafSize (voxelLeafSize);
+  }
+  if (compressDepth)
+    sensePtr->compressedPub =
+      nh->advertise < sensor_msgs::CompressedImage > ("image_mono/rvl", 2);
+  sensePtr->depthCodec.setStatsPeriod (statsPeriod);
+  //continuous scanning starts with the first imager in round robin mode
+  if (continuousScan && (!scanRoundRobin || sensors.size () == 1))
+    sensePtr->requestScan ();
   sensePtr->tf.header.frame_id = "base_link";
   sensePtr->tf.child_frame_id = ("/" + name).c_str ();
   sensePtr->opticalTransform.header.frame_id = "/" + name;
   sensePtr->opticalTransform.child_frame_id = "/" + name + "_optical";
+  sensePtr->opticalFrame = name + "_optical";
+  sensePtr->camInfo.header.frame_id = "/" + sensePtr->opticalFrame;
+  setThrottle (sensePtr);
   //create a transformation from the camera frame to the optical frame (image coordinates)
   tf::Quaternion quat;
   quat.setEuler (1.5707, 0, 1.5707);  //yaw, pitch, roll 
   tf::quaternionTFToMsg (quat, sensePtr->opticalTransform.transform.rotation);
+  if (staticTf)
+    sendStaticTransform (sensePtr->opticalTransform);
   return sensors.size () - 1;
 }
 
@@ -1839,33 +2254,102 @@ ServoInf::checkTrajectoryGoal (UsarsimActuator * act, const sw_struct * sw)
 }
 
 /*
-  Add a joint to the joints array if it hasn't already been added
+  Add a joint to the joints array if it hasn't already been added, or
+  else set its value. Joints are added as components are configured;
+  after that their values are updated in place through the index
+  returned.
 */
-void
-ServoInf::addJoint (std::string jointName, double jointValue)
+int
+ServoInf::addJoint (const std::string & jointName, double jointValue)
 {
-  for (unsigned int i = 0; i < joints.name.size (); i++)
+  unsigned int i;
+
+  ulapi_mutex_take (jointMutex);
+  for (i = 0; i < joints.name.size (); i++)
   {
     if (joints.name[i] == jointName)
-    {
-      joints.position[i] = jointValue;
-      return;
-    }
+      break;
+  }
+  if (i == joints.name.size ())
+  {
+    joints.name.push_back (jointName);
+    joints.position.push_back (jointValue);
   }
-  joints.name.push_back (jointName);
-  joints.position.push_back (jointValue);
+  else
+    joints.position[i] = jointValue;
+  ulapi_mutex_give (jointMutex);
+  return i;
 }
 
 /*
-  Publish all of the joint angles
+  Ask for the joint states to go out. They are sent once per simulator
+  tick, when the next tick starts or the batching delay runs out, or at
+  once with no batching delay.
 */
 void
 ServoInf::publishJoints ()
+{
+  ulapi_mutex_take (jointMutex);
+  if (!jointsDirty)
+    jointsDirtySince = ulapi_time ();
+  jointsDirty = true;
+  ulapi_mutex_give (jointMutex);
+  if (tfBatchDelay <= 0)
+    flushJoints (0);
+}
+
+/*
+  Publish the joint states, if they have been waiting at least \a minAge
+  seconds, along with the link transforms worked out from them.
+*/
+void
+ServoInf::flushJoints (double minAge)
 {
   ros::Time currentTime = ros::Time::now ();
-  joints.header.frame_id = "base_link";
-  joints.header.stamp = currentTime;
-  jointPublisher.publish (joints);
+
+  ulapi_mutex_take (jointMutex);
+  if (jointsDirty && ulapi_time () - jointsDirtySince >= minAge)
+  {
+    joints.header.stamp = currentTime;
+    jointPublisher.publish (joints);
+    if (publishLinkTf)
+      publishLinkTransforms (currentTime);
+    jointsDirty = false;
+  }
+  ulapi_mutex_give (jointMutex);
+}
+
+/*
+  Publish the link transforms for the current joint values, stamped
+  like the joint states they come from.
+*/
+void
+ServoInf::publishLinkTransforms (const ros::Time & stamp)
+{
+  unsigned int i;
+
+  //joints are only ever added, so only new ones need looking up
+  for (i = kinematicsIndex.size (); i < joints.name.size (); i++)
+    kinematicsIndex.push_back (kinematics.jointIndex (joints.name[i]));
+  for (i = 0; i < joints.name.size (); i++)
+  {
+    if (kinematicsIndex[i] >= 0)
+      kinematics.setPosition (kinematicsIndex[i], joints.position[i]);
+  }
+  kinematics.update (stamp);
+  for (int j = 0; j < kinematics.size (); j++)
+  {
+    if (kinematics.isKnown (j))
+      sendTransform (kinematics.transform (j));
+  }
+  if (!staticTf)
+  {
+    for (i = 0; i < kinematics.fixed.size (); i++)
+    {
+      kinematics.fixed[i].header.stamp = stamp;
+      sendTransform (kinematics.fixed[i]);
+    }
+  }
 }
 
 void *
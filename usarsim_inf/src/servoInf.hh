@@ -36,12 +36,14 @@
 #include <ros/ros.h>
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
+#include <tf/tfMessage.h>
 #include <nav_msgs/Odometry.h>
 #include <sensor_msgs/LaserScan.h>
 #include <sensor_msgs/Image.h>
 #include "genericInf.hh"
 #include "simware.hh"
 #include "usarsimInf.hh"
+#include "usarsimKinematics.hh"
 
 
 ////////////////////////////////////////////////////////////////
@@ -59,7 +61,10 @@ public:
   enum servoMutex
   {
     SERVO_SET_KEY = 101,
-    SERVO_STAT_KEY
+    SERVO_STAT_KEY,
+    SERVO_TF_KEY,
+    SERVO_JOINT_KEY,
+    SERVO_SCAN_KEY
   };
 
     ServoInf ();
@@ -80,11 +85,42 @@ public:
 private:
   bool buildTFTree; //whether or not the TF tree should be built. If false, rely on the robot_state_publisher node for some tf broadcasting.
   std::string odomName;
+  bool publishCloud; //publish range imager scans as point clouds
+  bool cloudSkipInvalid; //leave no-return pixels out of the clouds
+  double voxelLeafSize; //publish voxel downsampled clouds if above 0
+  bool lazySensors; //don't parse sensor data nobody subscribes to
+  bool depthMillimetres; //publish depth images as 16UC1 millimetres
+  bool compressDepth; //also publish RVL compressed depth images
+  double statsPeriod; //seconds between encoder reports, 0 for none
+  bool continuousScan; //request each range imager scan as the last ends
+  double scanPeriod; //least time between scan requests, 0 for no limit
+  bool scanRoundRobin; //scan with one range imager at a time, in turn
+  double scanTimeout; //ask again if a scan hasn't ended after this long
+  ros::Timer scanWatchdog;
+  bool staticTf; //publish fixed mounts once, latched on /tf_static
+  ros::Publisher staticTfPublisher;
+  tf::tfMessage staticTransforms; //every fixed frame, as last published
+  double tfBatchDelay; //longest a transform waits to go out with its tick, 0 to send at once
+  std::vector<geometry_msgs::TransformStamped> tfBatch; //transforms of the current tick
+  double tfBatchTime; //simulator time of the current tick
+  double tfBatchStart; //when the first transform of the batch was queued
+  void *tfBatchMutex;
+  ros::Timer tfBatchTimer;
+  void tfBatchCallback(const ros::TimerEvent &event);
+  bool publishLinkTf; //publish link tf from the joints, as robot_state_publisher does
+  UsarsimKinematics kinematics;
+  std::vector<int> kinematicsIndex; //kinematics joint for each joint state entry, or -1
+  void publishLinkTransforms(const ros::Time &stamp);
+  void scanWatchdogCallback(const ros::TimerEvent &event);
+  void *scanMutex; //rangeImagers and scanRequested, shared with the watchdog
   static void *servoSetMutex;
   //  ros::Rate *loopRate;
   ros::NodeHandle n;
   tf::TransformListener tfListener;
-  sensor_msgs::JointState joints; //joint state for the entire robot
+  sensor_msgs::JointState joints; //joint state for the entire robot, sent once per tick
+  bool jointsDirty; //joints changed since they were last published
+  double jointsDirtySince;
+  void *jointMutex; //joints are also published from the batching timer
   ros::Publisher jointPublisher;
   
   UsarsimPlatform *basePlatform;
@@ -94,8 +130,15 @@ private:
   void setTransform(UsarsimSensor *sen, const sw_pose &pose);
   void setTransform(UsarsimSensor *sen, const sw_pose &pose, const sw_pose &tip);
   void broadcastTransform(geometry_msgs::TransformStamped &tf);
-  void addJoint(std::string jointName, double jointValue);
+  void sendTransform(const geometry_msgs::TransformStamped &tf);
+  void flushTransforms();
+  void sendStaticTransform(geometry_msgs::TransformStamped &tf);
+  void publishMount(UsarsimSensor *sen, bool changed);
+  int addJoint(const std::string &jointName, double jointValue);
   void publishJoints();
+  void flushJoints(double minAge);
+  bool checkInterest(UsarsimSensor *sen, sw_type type, unsigned int listeners);
+  void setThrottle(UsarsimSensor *sen);
   
   //! We will always need a transform
   tf::TransformBroadcaster rosTfBroadcaster;
@@ -111,8 +154,8 @@ private:
   std::vector < UsarsimGripperEffector > grippers;
   //! Toolchangers
   std::vector < UsarsimToolchanger > toolchangers;
-  //! Range imager sensors
-  std::vector < UsarsimRngImgSensor > rangeImagers;
+  //! Range imager sensors, a deque so timers and subscribers can keep pointers
+  std::deque < UsarsimRngImgSensor > rangeImagers;
   UsarsimActuator* actuatorIn (std::list < UsarsimActuator > &actuatorsIn,
 		     std::string name);
   int odomSensorIndex (std::vector < UsarsimOdomSensor > &sensors,
@@ -125,7 +168,7 @@ private:
   std::string name);
   int toolchangerIndex (std::vector <UsarsimToolchanger > &effectors, 
   std::string name);
-  int rangeImagerIndex (std::vector < UsarsimRngImgSensor > &sensors,
+  int rangeImagerIndex (std::deque < UsarsimRngImgSensor > &sensors,
 			std::string name);
 			
 	template <class T>
@@ -140,7 +183,11 @@ private:
   int copyGripperEffector(UsarsimGripperEffector *effector, const sw_struct *sw);
   int copyToolchanger(UsarsimToolchanger *effector, const sw_struct *sw);
   int copyRangeImager (UsarsimRngImgSensor * sen, const sw_struct * sw);
+  void publishRangeImagerCloud (UsarsimRngImgSensor * sen, const sw_struct * sw);
+  void publishRangeImagerDepth (UsarsimRngImgSensor * sen, const sw_struct * sw);
+  void scanFinished (unsigned int num);
   void VelCmdCallback (const geometry_msgs::TwistConstPtr & msg);
+  void compileActuatorChain(UsarsimActuator *act, const sw_struct *sw);
   int updateActuatorTF(UsarsimActuator *act, const sw_struct *sw, bool broadcastTF);
   void updateActuatorCycle(UsarsimActuator *act);
   bool updateTrajectory(UsarsimActuator *act, const sw_struct *sw);
@@ -19,6 +19,7 @@
 #ifndef SIMWARE_H
 #define SIMWARE_H
 
+#include <set>
 #include <string>
 
 #define SW_NAME_MAX 80
@@ -196,7 +197,7 @@ typedef struct
   int numCargo;
   int id[SW_MAX_CARGO];
   int memory[SW_MAX_CARGO];
-  sw_pose position[SW_MAX_CARGO];
+  sw_pose *position;		/*!< SW_MAX_CARGO entries, owned by the component */
 } sw_cargo_struct;
 
 enum
@@ -239,7 +240,7 @@ typedef struct
   int frame;			/*!< Frame number (out of totalframes), frames must break on a line boundary */
   int totalframes;		/*!< Total number of frames */
   int numberperframe;		/*!< how many elements in this message  */
-  float range[SW_SEN_RANGEIMAGER_MAX];
+  float *range;			/*!< SW_SEN_RANGEIMAGER_MAX values, owned by the component */
   double maxrange;
   double minrange;
   double resolutionx;
@@ -255,10 +256,11 @@ enum
   SW_SEN_RANGESCANNER_STAT = 1,
   SW_SEN_RANGESCANNER_SET
 };
-#define SW_SEN_RANGESCANNER_MAX 192	/*!< how many ranges we can have  */
+#define SW_SEN_RANGESCANNER_MAX 192	/*!< initial range capacity, grown as scans need */
 typedef struct
 {
-  double range[SW_SEN_RANGESCANNER_MAX];
+  float *range;			/*!< capacity values, owned by the component */
+  int capacity;			/*!< how many ranges fit in range */
   double maxrange;
   double minrange;
   double resolution;
@@ -371,10 +373,16 @@ typedef struct
   double duration;		/*!< how long the sound was */
 } sw_sen_acoustic_struct;
 
+/*! names seen by a sensor. The pool is emptied when it holds more than
+  SW_NAME_POOL_MAX names, before the sensor's next message is parsed, so
+  pointers to them are only good until then; queued records keep their
+  own copies */
+typedef std::set < std::string > sw_name_pool;
+#define SW_NAME_POOL_MAX 1024
 typedef struct
 {
-  char tag[SW_NAME_MAX];
-  char material_name[SW_NAME_MAX];
+  const std::string *tag;	/*!< in the sensor's name pool, or a queue slot */
+  const std::string *material_name;	/*!< as for tag */
   sw_pose position;
   sw_pose hit_location;
 } sw_sen_object_struct;
@@ -383,9 +391,12 @@ enum
 	SW_SEN_OBJECTSENSOR_STAT = 1,
 	SW_SEN_OBJECTSENSOR_SET
 };
+#define SW_SEN_OBJECTSENSOR_MAX 16	/*!< initial object capacity, grown as needed */
 typedef struct
 {
-  sw_sen_object_struct objects[SW_SEN_RANGESCANNER_MAX];
+  sw_sen_object_struct *objects;	/*!< capacity entries, owned by the component */
+  int capacity;			/*!< how many objects fit in objects */
+  sw_name_pool *names;		/*!< owned by the component */
   sw_pose mount;
   double fov;
   int number; //the number of objects detected by the sensor
@@ -462,7 +473,7 @@ typedef struct
 {
   sw_pose mount;
   sw_pose tip;
-  sw_link_struct link[SW_ACT_LINK_MAX];
+  sw_link_struct *link;		/*!< SW_ACT_LINK_MAX entries, owned by the component */
   int number;			/*!< how many links */
 } sw_actuator_struct;
 
@@ -32,6 +32,7 @@
 #include <sys/time.h>		/* gettimeofday(), struct timeval */
 #include <unistd.h>		/* select(), write() */
 #include <sys/sem.h>
+#include <semaphore.h>		/* sem_t, sem_init() */
 #include <errno.h>
 #include <fcntl.h>		/* O_RDONLY, O_NONBLOCK */
 #include <sys/types.h>		/* fd_set, FD_ISSET() */
@@ -241,6 +242,52 @@ ulapi_mutex_take (void *mutex)
 	  ULAPI_ERROR);
 }
 
+void *
+ulapi_sem_new (ulapi_id key)
+{
+  sem_t *sem;
+
+  sem = (sem_t *) malloc (sizeof (sem_t));
+  if (NULL == (void *) sem)
+    return NULL;
+
+  /* process-private, initially taken */
+  if (0 == sem_init (sem, 0, 0))
+    return (void *) sem;
+
+  free (sem);
+  return NULL;
+}
+
+ulapi_result
+ulapi_sem_delete (void *sem)
+{
+  if (NULL == sem)
+    return ULAPI_ERROR;
+
+  (void) sem_destroy ((sem_t *) sem);
+  free (sem);
+
+  return ULAPI_OK;
+}
+
+ulapi_result
+ulapi_sem_give (void *sem)
+{
+  return 0 == sem_post ((sem_t *) sem) ? ULAPI_OK : ULAPI_ERROR;
+}
+
+ulapi_result
+ulapi_sem_take (void *sem)
+{
+  /* retry if a signal interrupts the wait */
+  while (0 != sem_wait ((sem_t *) sem))
+    if (errno != EINTR)
+      return ULAPI_ERROR;
+
+  return ULAPI_OK;
+}
+
 ulapi_result
 ulapi_socket_close (ulapi_integer id)
 {
@@ -356,6 +403,16 @@ ulapi_task_init (void)
   return ULAPI_OK;
 }
 
+ulapi_real
+ulapi_time (void)
+{
+  struct timeval tv;
+
+  gettimeofday (&tv, NULL);
+
+  return ((ulapi_real) tv.tv_sec) + ((ulapi_real) tv.tv_usec) * 1.0e-6;
+}
+
 void
 ulapi_sleep (ulapi_real secs)
 {
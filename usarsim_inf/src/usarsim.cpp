@@ -48,6 +48,7 @@ main (int argc, char **argv)
   ServoInf *servo;		// servo level interface
   UsarsimInf *usarsim;		// usarsim interface
   void *rosTask = NULL;
+  int err;
   // init ros
   ros::init (argc, argv, "usarsim");
   //  ros::Rate r(60);
@@ -77,7 +78,13 @@ main (int argc, char **argv)
   // main loop
   while ((usarsim->getNH ())->ok ())
     {
-      if (usarsim->msgIn () != 1)
+      err = usarsim->msgIn ();
+      if (err == 0)
+	{
+	  ROS_INFO ("Replay finished, exiting");
+	  break;
+	}
+      if (err != 1)
 	{
 	  ROS_ERROR ("Error from usarsimInf, exiting");
 	  break;
@@ -0,0 +1,167 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimCapture.cpp
+  \brief  Records and replays the raw byte stream from USARSim.
+*/
+#include <string.h>
+#include <stdint.h>
+#include <ros/ros.h>
+#include "ulapi.hh"
+#include "usarsimCapture.hh"
+
+#define CAPTURE_BUFFER_SIZE (64 * 1024)
+
+UsarsimCapture::UsarsimCapture ()
+{
+  fp = NULL;
+  replay = 0;
+  startTime = 0;
+  rate = 0;
+  remaining = 0;
+}
+
+UsarsimCapture::~UsarsimCapture ()
+{
+  close ();
+}
+
+void
+UsarsimCapture::close ()
+{
+  if (fp != NULL)
+    fclose (fp);
+  fp = NULL;
+}
+
+/*!
+  Start a new capture in \a fileName, replacing any old one.
+  \return 1 on success, -1 on failure.
+*/
+int
+UsarsimCapture::openWrite (const char *fileName)
+{
+  close ();
+  fp = fopen (fileName, "wb");
+  if (fp == NULL)
+    {
+      ROS_ERROR ("UsarsimCapture: can't create %s", fileName);
+      return -1;
+    }
+  setvbuf (fp, NULL, _IOFBF, CAPTURE_BUFFER_SIZE);
+  if (fwrite (USARSIM_CAPTURE_MAGIC, USARSIM_CAPTURE_MAGIC_LEN, 1, fp) != 1)
+    {
+      ROS_ERROR ("UsarsimCapture: can't write to %s", fileName);
+      close ();
+      return -1;
+    }
+  replay = 0;
+  startTime = ulapi_time ();
+  return 1;
+}
+
+/*!
+  Replay \a fileName. A \a rate of 1 keeps the recorded timing, 2 plays
+  twice as fast, and 0 plays as fast as the data is read.
+  \return 1 on success, -1 on failure.
+*/
+int
+UsarsimCapture::openRead (const char *fileName, double rateIn)
+{
+  char magic[USARSIM_CAPTURE_MAGIC_LEN];
+
+  close ();
+  fp = fopen (fileName, "rb");
+  if (fp == NULL)
+    {
+      ROS_ERROR ("UsarsimCapture: can't open %s", fileName);
+      return -1;
+    }
+  setvbuf (fp, NULL, _IOFBF, CAPTURE_BUFFER_SIZE);
+  if (fread (magic, sizeof (magic), 1, fp) != 1
+      || memcmp (magic, USARSIM_CAPTURE_MAGIC, sizeof (magic)) != 0)
+    {
+      ROS_ERROR ("UsarsimCapture: %s is not a capture file", fileName);
+      close ();
+      return -1;
+    }
+  replay = 1;
+  rate = rateIn;
+  remaining = 0;
+  startTime = ulapi_time ();
+  return 1;
+}
+
+/*!
+  Append one record holding \a len bytes of \a data, stamped with the
+  time since the capture started.
+  \return 1 on success, -1 on a write error, after which capturing stops.
+*/
+int
+UsarsimCapture::write (const char *data, size_t len)
+{
+  double when;
+  uint32_t length = len;
+
+  if (fp == NULL || replay)
+    return -1;
+  when = ulapi_time () - startTime;
+  if (fwrite (&when, sizeof (when), 1, fp) != 1
+      || fwrite (&length, sizeof (length), 1, fp) != 1
+      || fwrite (data, 1, len, fp) != len)
+    {
+      ROS_ERROR ("UsarsimCapture: write failed, capture stopped");
+      close ();
+      return -1;
+    }
+  return 1;
+}
+
+/*!
+  Read up to \a size bytes of the recorded stream. A record bigger than
+  \a size is handed out over several calls. When pacing, the call waits
+  until the record's time has come.
+  \return the number of bytes read, 0 at the end of the capture and -1
+  on error.
+*/
+int
+UsarsimCapture::read (char *data, size_t size)
+{
+  double when;
+  double delay;
+  uint32_t length;
+  size_t n;
+
+  if (fp == NULL || !replay)
+    return -1;
+  if (remaining == 0)
+    {
+      if (fread (&when, sizeof (when), 1, fp) != 1
+	  || fread (&length, sizeof (length), 1, fp) != 1)
+	return 0;
+      remaining = length;
+      if (rate > 0)
+	{
+	  delay = startTime + when / rate - ulapi_time ();
+	  if (delay > 0)
+	    ulapi_sleep (delay);
+	}
+    }
+  n = remaining < size ? remaining : size;
+  if (fread (data, 1, n, fp) != n)
+    {
+      /* a capture cut short mid-record ends here */
+      remaining = 0;
+      return 0;
+    }
+  remaining -= n;
+  return n;
+}
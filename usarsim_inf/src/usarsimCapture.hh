@@ -0,0 +1,65 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimCapture.hh
+  \brief  Records and replays the raw byte stream from USARSim.
+
+  A capture file starts with the 8 byte magic "USARCAP1" and is followed
+  by one record per socket read:
+
+  \code
+  double   seconds since the capture started
+  uint32   length of the data
+  char     data[length]
+  \endcode
+
+  in host byte order. Records are only ever appended, so a capture cut
+  short by a crash is still readable up to its last complete record.
+
+  Replaying hands the same bytes back, either paced by the recorded
+  times (scaled by a rate) or as fast as the reader takes them, so the
+  parser and publishers can be exercised without a simulator.
+*/
+#ifndef __usarsimCapture__
+#define __usarsimCapture__
+#include <stdio.h>
+#include <stddef.h>
+
+#define USARSIM_CAPTURE_MAGIC "USARCAP1"
+#define USARSIM_CAPTURE_MAGIC_LEN 8
+
+class UsarsimCapture
+{
+public:
+  UsarsimCapture ();
+  ~UsarsimCapture ();
+  int openWrite (const char *fileName);
+  int openRead (const char *fileName, double rate);
+  int write (const char *data, size_t len);
+  int read (char *data, size_t size);
+  bool isOpen ()
+  {
+    return fp != NULL;
+  }
+  bool isReplay ()
+  {
+    return fp != NULL && replay;
+  }
+
+private:
+  FILE *fp;
+  int replay;
+  double startTime;
+  double rate;			// 0 replays as fast as possible
+  size_t remaining;		// bytes left in the current record
+  void close ();
+};
+#endif
@@ -0,0 +1,323 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimCloud.cpp
+  \brief  Turns range imager depth images into point clouds.
+*/
+#include <math.h>
+#include <limits>
+#include <ros/ros.h>
+#include <sensor_msgs/image_encodings.h>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+#include "usarsimCloud.hh"
+
+#define POINT_STEP (4 * sizeof (float))
+
+UsarsimDepthCloud::UsarsimDepthCloud ()
+{
+  width = height = 0;
+  fovx = fovy = 0;
+}
+
+/*!
+  Build the ray table for a \a width x \a height image with horizontal
+  and vertical fields of view \a fovxIn and \a fovyIn in radians. A
+  vertical field of view of 0 means square pixels.
+*/
+void
+UsarsimDepthCloud::setRays (int widthIn, int heightIn, double fovxIn,
+			    double fovyIn)
+{
+  double fx, fy, cx, cy;
+  float *ray;
+
+  if (widthIn == width && heightIn == height && fovxIn == fovx
+      && fovyIn == fovy)
+    return;
+  width = widthIn;
+  height = heightIn;
+  fovx = fovxIn;
+  fovy = fovyIn;
+  rays.resize (4 * (size_t) width * height);
+  if (width <= 0 || height <= 0 || fovx <= 0)
+    return;
+
+  /* pinhole model centered on the image */
+  fx = (width / 2.) / tan (fovx / 2.);
+  fy = fovy > 0 ? (height / 2.) / tan (fovy / 2.) : fx;
+  cx = (width - 1) / 2.;
+  cy = (height - 1) / 2.;
+  ray = &rays[0];
+  for (int v = 0; v < height; v++)
+    {
+      for (int u = 0; u < width; u++)
+	{
+	  ray[0] = (u - cx) / fx;
+	  ray[1] = (v - cy) / fy;
+	  ray[2] = 1;
+	  ray[3] = 0;
+	  ray += 4;
+	}
+    }
+}
+
+/* describe 16 byte x, y, z points, unless that's already done */
+static void
+setFields (sensor_msgs::PointCloud2 & cloud)
+{
+  const char *names[] = { "x", "y", "z" };
+
+  if (cloud.fields.size () == 3)
+    return;
+  cloud.fields.resize (3);
+  for (int i = 0; i < 3; i++)
+    {
+      cloud.fields[i].name = names[i];
+      cloud.fields[i].offset = i * sizeof (float);
+      cloud.fields[i].datatype = sensor_msgs::PointField::FLOAT32;
+      cloud.fields[i].count = 1;
+    }
+  cloud.is_bigendian = false;
+  cloud.point_step = POINT_STEP;
+}
+
+/*!
+  Deproject the 32FC1 image \a depth into \a cloud. Depths that are not
+  between \a minRange and \a maxRange (no return, which USARSim reports
+  as the maximum range) are invalid. With \a skipInvalid they are left
+  out and the cloud is a dense list; otherwise the cloud keeps the
+  image's shape and invalid points are NaN. A \a maxRange of 0 means
+  no limit. The cloud's buffer is reused between calls.
+  \return the number of valid points, or -1 if the image doesn't match
+  the ray table.
+*/
+int
+UsarsimDepthCloud::build (const sensor_msgs::Image & depth, double minRange,
+			  double maxRange, bool skipInvalid,
+			  sensor_msgs::PointCloud2 & cloud)
+{
+  size_t pixels = (size_t) width * height;
+  const float *range;
+  const float *ray;
+  float *out;
+  float lo = minRange > 0 ? minRange : 0;
+  float hi = maxRange > 0 ? maxRange : std::numeric_limits < float >::max ();
+  float d;
+  int valid;
+  size_t count = 0;
+
+  if ((int) depth.width != width || (int) depth.height != height
+      || depth.encoding != sensor_msgs::image_encodings::TYPE_32FC1
+      || depth.data.size () < pixels * sizeof (float) || fovx <= 0)
+    return -1;
+  setFields (cloud);
+  cloud.header = depth.header;
+  cloud.data.resize (pixels * POINT_STEP);
+  if (pixels == 0)
+    return 0;
+
+  range = (const float *) &depth.data[0];
+  ray = &rays[0];
+  out = (float *) &cloud.data[0];
+#ifdef __SSE__
+  const __m128 nan = _mm_set1_ps (std::numeric_limits < float >::quiet_NaN ());
+  for (size_t i = 0; i < pixels; i++, ray += 4)
+    {
+      d = range[i];
+      /* NaN depths fail both compares */
+      valid = d > lo && d < hi;
+      if (valid)
+	_mm_storeu_ps (out, _mm_mul_ps (_mm_set1_ps (d), _mm_loadu_ps (ray)));
+      else if (!skipInvalid)
+	_mm_storeu_ps (out, nan);
+      if (valid || !skipInvalid)
+	out += 4;
+      count += valid;
+    }
+#else
+  const float nan = std::numeric_limits < float >::quiet_NaN ();
+  for (size_t i = 0; i < pixels; i++, ray += 4)
+    {
+      d = range[i];
+      valid = d > lo && d < hi;
+      if (valid)
+	{
+	  out[0] = d * ray[0];
+	  out[1] = d * ray[1];
+	  out[2] = d;
+	  out[3] = 0;
+	}
+      else if (!skipInvalid)
+	out[0] = out[1] = out[2] = out[3] = nan;
+      if (valid || !skipInvalid)
+	out += 4;
+      count += valid;
+    }
+#endif
+
+  if (skipInvalid)
+    {
+      /* shrinking never reallocates, so the buffer is kept */
+      cloud.data.resize (count * POINT_STEP);
+      cloud.height = 1;
+      cloud.width = count;
+      cloud.is_dense = true;
+    }
+  else
+    {
+      cloud.height = height;
+      cloud.width = width;
+      cloud.is_dense = count == pixels;
+    }
+  cloud.row_step = cloud.width * POINT_STEP;
+  return count;
+}
+
+////////////////////////////////////////////////////////////////////////
+// UsarsimVoxelGrid
+////////////////////////////////////////////////////////////////////////
+/* voxel coordinates are packed 21 bits apiece into a 64 bit key */
+#define VOXEL_BITS 21
+#define VOXEL_OFFSET (1 << (VOXEL_BITS - 1))
+#define VOXEL_MIN_TABLE 1024
+
+static inline bool
+isFinite (const float *p)
+{
+  /* NaN and infinity both fail */
+  return p[0] - p[0] == 0 && p[1] - p[1] == 0 && p[2] - p[2] == 0;
+}
+
+UsarsimVoxelGrid::UsarsimVoxelGrid ()
+{
+  leafSize = 0;
+  generation = 0;
+}
+
+void
+UsarsimVoxelGrid::setLeafSize (double size)
+{
+  leafSize = size;
+}
+
+/*
+  Make room for a cloud of \a points points. The table is kept at least
+  twice as big as the most voxels there can be, so probes stay short.
+*/
+void
+UsarsimVoxelGrid::reserve (size_t points)
+{
+  size_t size = VOXEL_MIN_TABLE;
+  Slot empty;
+
+  arena.reserve (points);
+  while (size < 2 * points)
+    size *= 2;
+  if (size <= table.size ())
+    return;
+  empty.generation = 0;
+  empty.voxel = 0;
+  table.assign (size, empty);
+  generation = 0;
+}
+
+/*!
+  Downsample \a in, a cloud from UsarsimDepthCloud, into \a out with one
+  point at the centroid of each occupied voxel. Points that are NaN, or
+  too far out to be given a voxel, are left out. The buffers in \a out
+  and the voxel grid's own are reused between calls.
+  \return the number of points in \a out, or -1 if there is no leaf
+  size or \a in is not a cloud of x, y, z floats.
+*/
+int
+UsarsimVoxelGrid::filter (const sensor_msgs::PointCloud2 & in,
+			  sensor_msgs::PointCloud2 & out)
+{
+  size_t points = (size_t) in.width * in.height;
+  size_t mask;
+  size_t h;
+  const float *p;
+  float *q;
+  float inv;
+  long ix, iy, iz;
+  uint64_t key;
+  Voxel voxel;
+  Voxel *v;
+
+  if (leafSize <= 0 || in.point_step < 3 * sizeof (float)
+      || in.data.size () < points * in.point_step)
+    return -1;
+  reserve (points);
+  arena.clear ();
+  if (++generation == 0)
+    {
+      /* wrapped, so stale entries could look current */
+      for (h = 0; h < table.size (); h++)
+	table[h].generation = 0;
+      generation = 1;
+    }
+  mask = table.size () - 1;
+  inv = 1. / leafSize;
+
+  for (size_t i = 0; i < points; i++)
+    {
+      p = (const float *) &in.data[i * in.point_step];
+      if (!isFinite (p))
+	continue;
+      ix = (long) floorf (p[0] * inv) + VOXEL_OFFSET;
+      iy = (long) floorf (p[1] * inv) + VOXEL_OFFSET;
+      iz = (long) floorf (p[2] * inv) + VOXEL_OFFSET;
+      if (ix < 0 || ix >= 2 * VOXEL_OFFSET || iy < 0
+	  || iy >= 2 * VOXEL_OFFSET || iz < 0 || iz >= 2 * VOXEL_OFFSET)
+	continue;
+      key = ((uint64_t) ix << (2 * VOXEL_BITS))
+	| ((uint64_t) iy << VOXEL_BITS) | (uint64_t) iz;
+
+      /* Fibonacci hashing, then linear probing */
+      h = (size_t) ((key * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+      while (table[h].generation == generation
+	     && arena[table[h].voxel].key != key)
+	h = (h + 1) & mask;
+      if (table[h].generation != generation)
+	{
+	  table[h].generation = generation;
+	  table[h].voxel = arena.size ();
+	  voxel.key = key;
+	  voxel.sum[0] = voxel.sum[1] = voxel.sum[2] = 0;
+	  voxel.count = 0;
+	  arena.push_back (voxel);
+	}
+      v = &arena[table[h].voxel];
+      v->sum[0] += p[0];
+      v->sum[1] += p[1];
+      v->sum[2] += p[2];
+      v->count++;
+    }
+
+  setFields (out);
+  out.header = in.header;
+  out.data.resize (arena.size () * POINT_STEP);
+  q = arena.empty ()? NULL : (float *) &out.data[0];
+  for (size_t i = 0; i < arena.size (); i++, q += 4)
+    {
+      q[0] = arena[i].sum[0] / arena[i].count;
+      q[1] = arena[i].sum[1] / arena[i].count;
+      q[2] = arena[i].sum[2] / arena[i].count;
+      q[3] = 0;
+    }
+  out.height = 1;
+  out.width = arena.size ();
+  out.is_dense = true;
+  out.row_step = out.width * POINT_STEP;
+  return arena.size ();
+}
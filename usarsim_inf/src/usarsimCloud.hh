@@ -0,0 +1,81 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimCloud.hh
+  \brief  Turns range imager depth images into point clouds.
+
+  UsarsimDepthCloud keeps a table holding, for every pixel, the ray
+  (x/z, y/z, 1) through that pixel in the optical frame, worked out from
+  the resolution and field of view. A point is then the ray scaled by
+  the pixel's depth, which is one 4-wide multiply per pixel with SSE.
+  The table is only rebuilt when the resolution or field of view
+  changes.
+
+  Points are 16 bytes (x, y, z and padding), the PCL PointXYZ layout.
+
+  UsarsimVoxelGrid downsamples such a cloud to one point per occupied
+  cube of a given leaf size, at the centroid of the points in it. The
+  voxels are found through an open addressing hash table and summed in
+  an arena; both keep their memory from one cloud to the next and the
+  table is emptied by bumping a generation count rather than by
+  clearing it.
+*/
+#ifndef __usarsimCloud__
+#define __usarsimCloud__
+#include <stdint.h>
+#include <vector>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/PointCloud2.h>
+
+class UsarsimDepthCloud
+{
+public:
+  UsarsimDepthCloud ();
+  void setRays (int width, int height, double fovx, double fovy);
+  int build (const sensor_msgs::Image & depth, double minRange,
+	     double maxRange, bool skipInvalid,
+	     sensor_msgs::PointCloud2 & cloud);
+
+private:
+  std::vector < float >rays;	// 4 floats per pixel
+  int width;
+  int height;
+  double fovx;
+  double fovy;
+};
+
+class UsarsimVoxelGrid
+{
+public:
+  UsarsimVoxelGrid ();
+  void setLeafSize (double size);
+  int filter (const sensor_msgs::PointCloud2 & in,
+	      sensor_msgs::PointCloud2 & out);
+
+private:
+  struct Voxel
+  {
+    uint64_t key;
+    float sum[3];
+    unsigned int count;
+  };
+  struct Slot
+  {
+    unsigned int generation;	// table entry is empty unless current
+    unsigned int voxel;		// index into the arena
+  };
+  double leafSize;
+  std::vector < Voxel > arena;
+  std::vector < Slot > table;	// size is a power of 2
+  unsigned int generation;
+  void reserve (size_t points);
+};
+#endif
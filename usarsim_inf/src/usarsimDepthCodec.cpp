@@ -0,0 +1,235 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimDepthCodec.cpp
+  \brief  Compact encodings of range imager depth images.
+*/
+#include <math.h>
+#include <string.h>
+#include <ros/ros.h>
+#include <sensor_msgs/image_encodings.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "ulapi.hh"
+#include "usarsimDepthCodec.hh"
+
+/* the deepest depth 16-bit millimetres can hold */
+#define MAX_MM_DEPTH 65.535f
+
+UsarsimDepthEncoder::UsarsimDepthEncoder ()
+{
+  converted = compressed = 0;
+  convertTime = compressTime = 0;
+  rawBytes = compressedBytes = 0;
+  statsPeriod = 0;
+  lastStatsTime = 0;
+}
+
+void
+UsarsimDepthEncoder::setStatsPeriod (double period)
+{
+  statsPeriod = period;
+  lastStatsTime = ulapi_time ();
+}
+
+/*!
+  Convert the 32FC1 image \a depth, in metres, to 16UC1 millimetres in
+  \a out. Depths that are not between \a minRange and \a maxRange, or
+  that don't fit in 16 bits, become 0. A \a maxRange of 0 means no
+  limit. The buffer in \a out is reused between calls.
+  \return the number of pixels, or -1 if \a depth is not 32FC1.
+*/
+int
+UsarsimDepthEncoder::toMillimetres (const sensor_msgs::Image & depth,
+				    double minRange, double maxRange,
+				    sensor_msgs::Image & out)
+{
+  size_t pixels = (size_t) depth.width * depth.height;
+  size_t i = 0;
+  const float *in;
+  uint16_t *mm;
+  float lo = minRange > 0 ? minRange : 0;
+  float hi = maxRange > 0 && maxRange < MAX_MM_DEPTH ? maxRange : MAX_MM_DEPTH;
+  float d;
+  double start = ulapi_time ();
+
+  if (depth.encoding != sensor_msgs::image_encodings::TYPE_32FC1
+      || depth.data.size () < pixels * sizeof (float))
+    return -1;
+  out.header = depth.header;
+  out.width = depth.width;
+  out.height = depth.height;
+  out.encoding = sensor_msgs::image_encodings::TYPE_16UC1;
+  out.is_bigendian = depth.is_bigendian;
+  out.step = depth.width * sizeof (uint16_t);
+  out.data.resize (pixels * sizeof (uint16_t));
+  if (pixels == 0)
+    return 0;
+
+  in = (const float *) &depth.data[0];
+  mm = (uint16_t *) & out.data[0];
+#ifdef __SSE2__
+  const __m128 scale = _mm_set1_ps (1000.f);
+  const __m128 vlo = _mm_set1_ps (lo);
+  const __m128 vhi = _mm_set1_ps (hi);
+  const __m128i bias = _mm_set1_epi32 (32768);
+  const __m128i flip = _mm_set1_epi16 ((short) 0x8000);
+  for (; i + 8 <= pixels; i += 8)
+    {
+      __m128 a = _mm_loadu_ps (in + i);
+      __m128 b = _mm_loadu_ps (in + i + 4);
+      /* NaN depths fail both compares and are masked to 0 */
+      __m128 va = _mm_and_ps (_mm_cmpgt_ps (a, vlo), _mm_cmplt_ps (a, vhi));
+      __m128 vb = _mm_and_ps (_mm_cmpgt_ps (b, vlo), _mm_cmplt_ps (b, vhi));
+      __m128i ia = _mm_and_si128 (_mm_cvtps_epi32 (_mm_mul_ps (a, scale)),
+				  _mm_castps_si128 (va));
+      __m128i ib = _mm_and_si128 (_mm_cvtps_epi32 (_mm_mul_ps (b, scale)),
+				  _mm_castps_si128 (vb));
+      /*
+         packs saturates to signed 16 bits, so 0..65535 is shifted down
+         into that range and the top bit flipped back afterwards
+       */
+      __m128i packed = _mm_packs_epi32 (_mm_sub_epi32 (ia, bias),
+					_mm_sub_epi32 (ib, bias));
+      _mm_storeu_si128 ((__m128i *) (mm + i), _mm_xor_si128 (packed, flip));
+    }
+#endif
+  for (; i < pixels; i++)
+    {
+      d = in[i];
+      /* lrintf rounds to even like the SSE conversion */
+      mm[i] = d > lo && d < hi ? (uint16_t) lrintf (d * 1000.f) : 0;
+    }
+
+  converted++;
+  convertTime += ulapi_time () - start;
+  return pixels;
+}
+
+/* append \a value to the RVL stream, 3 bits to a nibble */
+static inline void
+putVle (uint32_t value, uint32_t *&out, uint32_t & word, int &nibbles)
+{
+  uint32_t nibble;
+
+  do
+    {
+      nibble = value & 0x7;
+      value >>= 3;
+      if (value)
+	nibble |= 0x8;
+      word = (word << 4) | nibble;
+      if (++nibbles == 8)
+	{
+	  *out++ = word;
+	  word = 0;
+	  nibbles = 0;
+	}
+    }
+  while (value);
+}
+
+/*!
+  Compress the 16UC1 image \a depth16 into \a out with RVL. The buffer
+  in \a out is reused between calls.
+  \return the size of the compressed data in bytes, or -1 if
+  \a depth16 is not 16UC1.
+*/
+int
+UsarsimDepthEncoder::compress (const sensor_msgs::Image & depth16,
+			       sensor_msgs::CompressedImage & out)
+{
+  size_t pixels = (size_t) depth16.width * depth16.height;
+  const uint16_t *in;
+  const uint16_t *end;
+  const uint16_t *p;
+  uint32_t header[2];
+  uint32_t *words;
+  uint32_t *next;
+  uint32_t word = 0;
+  uint32_t zeros, nonzeros;
+  int nibbles = 0;
+  int previous = 0;
+  int delta;
+  double start = ulapi_time ();
+
+  if (depth16.encoding != sensor_msgs::image_encodings::TYPE_16UC1
+      || depth16.data.size () < pixels * sizeof (uint16_t))
+    return -1;
+  out.header = depth16.header;
+  out.format = USARSIM_RVL_FORMAT;
+  /*
+     A pixel never costs more than 9 nibbles: 6 for its difference and
+     at most 3 as its share of the run lengths.
+   */
+  out.data.resize (sizeof (header)
+		   + ((9 * pixels) / 8 + 1) * sizeof (uint32_t));
+  header[0] = depth16.width;
+  header[1] = depth16.height;
+  memcpy (&out.data[0], header, sizeof (header));
+  words = next = (uint32_t *) & out.data[sizeof (header)];
+
+  in = pixels > 0 ? (const uint16_t *) &depth16.data[0] : NULL;
+  end = in + pixels;
+  while (in != end)
+    {
+      for (zeros = 0; in != end && *in == 0; in++)
+	zeros++;
+      putVle (zeros, next, word, nibbles);
+      for (nonzeros = 0, p = in; p != end && *p != 0; p++)
+	nonzeros++;
+      putVle (nonzeros, next, word, nibbles);
+      for (; in != p; in++)
+	{
+	  delta = *in - previous;
+	  /* zigzag, so small differences either way are small numbers */
+	  putVle (((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31), next,
+		  word, nibbles);
+	  previous = *in;
+	}
+    }
+  if (nibbles > 0)
+    *next++ = word << 4 * (8 - nibbles);
+  out.data.resize (sizeof (header) + (next - words) * sizeof (uint32_t));
+
+  compressed++;
+  compressTime += ulapi_time () - start;
+  rawBytes += pixels * sizeof (uint16_t);
+  compressedBytes += out.data.size ();
+  return out.data.size ();
+}
+
+/*!
+  Log the encoding cost and compression ratio for images of sensor
+  \a name if \a statsPeriod seconds have gone by since the last report.
+  A period of 0 disables reporting.
+*/
+void
+UsarsimDepthEncoder::updateStats (const std::string & name)
+{
+  double now;
+
+  if (statsPeriod <= 0)
+    return;
+  now = ulapi_time ();
+  if (now - lastStatsTime < statsPeriod)
+    return;
+  ROS_INFO ("UsarsimDepthEncoder %s: %lu converted at %.2f ms, "
+	    "%lu compressed at %.2f ms, %.2f:1", name.c_str (), converted,
+	    converted ? 1000. * convertTime / converted : 0., compressed,
+	    compressed ? 1000. * compressTime / compressed : 0.,
+	    compressedBytes > 0 ? rawBytes / compressedBytes : 0.);
+  converted = compressed = 0;
+  convertTime = compressTime = 0;
+  rawBytes = compressedBytes = 0;
+  lastStatsTime = now;
+}
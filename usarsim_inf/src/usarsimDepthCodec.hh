@@ -0,0 +1,66 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimDepthCodec.hh
+  \brief  Compact encodings of range imager depth images.
+
+  UsarsimDepthEncoder turns 32FC1 depth in metres into 16UC1 depth in
+  millimetres, half the size, with 0 marking pixels that have no valid
+  depth as depth_image_proc expects. The 16-bit image can then be
+  compressed losslessly with RVL (A. Wilson, "Fast Lossless Depth Image
+  Compression", 2017), a run-length and variable-length code that
+  works well on depth because valid pixels come in runs and neighbours
+  differ little.
+
+  A compressed image has the format "16UC1; rvl" and its data is
+
+  \code
+  uint32   width
+  uint32   height
+  uint32   words[]    RVL nibbles, first nibble in the top 4 bits
+  \endcode
+
+  in host byte order. Each run of zero pixels is coded as its length,
+  then the length of the following run of non-zero pixels, then each of
+  those as the zigzagged difference from the previous non-zero pixel.
+  Every number is written 3 bits to a nibble, low bits first, with the
+  top bit of the nibble set when more follow.
+*/
+#ifndef __usarsimDepthCodec__
+#define __usarsimDepthCodec__
+#include <stdint.h>
+#include <sensor_msgs/Image.h>
+#include <sensor_msgs/CompressedImage.h>
+
+#define USARSIM_RVL_FORMAT "16UC1; rvl"
+
+class UsarsimDepthEncoder
+{
+public:
+  UsarsimDepthEncoder ();
+  int toMillimetres (const sensor_msgs::Image & depth, double minRange,
+		     double maxRange, sensor_msgs::Image & out);
+  int compress (const sensor_msgs::Image & depth16,
+		sensor_msgs::CompressedImage & out);
+  void setStatsPeriod (double period);
+  void updateStats (const std::string & name);
+
+private:
+  unsigned long converted;	// images converted to 16 bits
+  unsigned long compressed;	// images compressed
+  double convertTime;		// seconds spent on each
+  double compressTime;
+  double rawBytes;		// 16-bit bytes in and compressed bytes out
+  double compressedBytes;
+  double statsPeriod;
+  double lastStatsTime;
+};
+#endif
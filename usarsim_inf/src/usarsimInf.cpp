@@ -27,27 +27,63 @@
   \author Stephen Balakirsky
   \date   October 19, 2011
 */
+#include <fcntl.h>		/* open(), O_WRONLY */
 #include "usarsimInf.hh"
+#include "usarsimParse.hh"
 #include <XmlRpcValue.h>
 
+#define INTEREST_MUTEX_KEY 5
+
 UsarsimInf::UsarsimInf ():GenericInf ()
 {
   socket_fd = -1;
-  socket_mutex = NULL;
-  buildlen = BUFFERLEN;
-  build = NULL;
   waitingForConf = 0;
   waitingForGeo = 0;
+  handshakeStarted = 0;
+  pipelineHandshake = 1;
+  handshakeTimeout = 1;
+  handshakeCount = 0;
+  ready = 0;
+  initTime = 0;
+  firstMsgTime = 0;
+  useQueue = 0;
+  synchronous = 0;
+  publishTask = NULL;
+  writerTask = NULL;
+  interestMutex = ulapi_mutex_new (INTEREST_MUTEX_KEY);
+  interestChanged = 0;
+  deletesPending = 0;
+}
+
+static void
+publishThread (void *arg)
+{
+  ((UsarsimInf *) arg)->publish ();
+}
+
+static void
+writerThread (void *arg)
+{
+  if (((UsarsimWriter *) arg)->run () < 0)
+    ROS_ERROR ("usarsim command writer stopped");
 }
 
 int
 UsarsimInf::init (GenericInf * siblingIn)
 {
   std::string hostname, startPosition, robotName, robotType;
+  std::string captureFile, replayFile;
+  double replayRate;
   std::stringstream tempSS;
   int port;
+  int readBufferSize;
+  int queueSize;
+  double statsPeriod;
+  bool pipeline;
+  std_msgs::Bool readyMsg;
 
   GenericInf::init (siblingIn);
+  initTime = ulapi_time ();
   /* get all of the parameters for starting usarsim we need:
      startPosition
      robotType
@@ -78,20 +114,108 @@ UsarsimInf::init (GenericInf * siblingIn)
   nh->param < int >("/usarsim/port", port, 3000);
   ROS_DEBUG ("parameter /usarsim/port: %d", port);
 
-  socket_fd = ulapi_socket_get_client_id (port, hostname.c_str ());
-  if (socket_fd < 0)
+  /* a replay reads a capture instead of the simulator, and throws
+     away everything we send */
+  nh->param < std::string > ("/usarsim/replayFile", replayFile, "");
+  ROS_DEBUG ("Parameter /usarsim/replayFile: %s", replayFile.c_str ());
+  nh->param < double >("/usarsim/replayRate", replayRate, 1.);
+  ROS_DEBUG ("parameter /usarsim/replayRate: %f", replayRate);
+  nh->param < std::string > ("/usarsim/captureFile", captureFile, "");
+  ROS_DEBUG ("Parameter /usarsim/captureFile: %s", captureFile.c_str ());
+
+  if (replayFile != "")
     {
-      ROS_ERROR ("can't open socket to %s port %d", hostname.c_str (), port);
-      return -1;
+      socket_fd = open ("/dev/null", O_WRONLY);
+      if (socket_fd < 0)
+	{
+	  ROS_ERROR ("can't open /dev/null for replay");
+	  return -1;
+	}
+    }
+  else
+    {
+      socket_fd = ulapi_socket_get_client_id (port, hostname.c_str ());
+      if (socket_fd < 0)
+	{
+	  ROS_ERROR ("can't open socket to %s port %d", hostname.c_str (),
+		     port);
+	  return -1;
+	}
     }
 
-  socket_mutex = ulapi_mutex_new (SOCKET_MUTEX_KEY);
-  if (NULL == socket_mutex)
+  /* every command goes out through the writer thread */
+  if (writer.init (socket_fd) < 0)
+    {
+      ulapi_socket_close (socket_fd);
+      socket_fd = -1;
+      return -1;
+    }
+  writerTask = ulapi_task_new ();
+  ulapi_task_start (writerTask, writerThread, (void *) &writer,
+		    ulapi_prio_lowest (), 1);
+
+  nh->param < int >("/usarsim/readBufferSize", readBufferSize,
+		    USARSIM_STREAM_DEFAULT_SIZE);
+  ROS_DEBUG ("parameter /usarsim/readBufferSize: %d", readBufferSize);
+  if (readBufferSize <= 0)
+    {
+      ROS_WARN ("/usarsim/readBufferSize %d is not a size, using %d",
+		readBufferSize, USARSIM_STREAM_DEFAULT_SIZE);
+      readBufferSize = USARSIM_STREAM_DEFAULT_SIZE;
+    }
+  nh->param < double >("/usarsim/statsPeriod", statsPeriod, 0.);
+  ROS_DEBUG ("parameter /usarsim/statsPeriod: %f", statsPeriod);
+  if (stream.init (socket_fd, readBufferSize, DELIMITER) < 0)
     {
       ulapi_socket_close (socket_fd);
       socket_fd = -1;
       return -1;
     }
+  stream.setStatsPeriod (statsPeriod);
+  if (replayFile != "")
+    {
+      if (stream.replayFrom (replayFile.c_str (), replayRate) < 0)
+	return -1;
+      ROS_INFO ("Replaying %s at %s", replayFile.c_str (),
+		replayRate > 0 ? "recorded speed" : "full speed");
+    }
+  else if (captureFile != "")
+    {
+      if (stream.captureTo (captureFile.c_str ()) < 0)
+	return -1;
+      ROS_INFO ("Capturing to %s", captureFile.c_str ());
+    }
+  writer.setStatsPeriod (statsPeriod);
+
+  /* a queue size of 0 publishes from the socket thread, as before */
+  nh->param < int >("/usarsim/queueSize", queueSize,
+		    USARSIM_QUEUE_DEFAULT_SIZE);
+  ROS_DEBUG ("parameter /usarsim/queueSize: %d", queueSize);
+  if (synchronous)
+    queueSize = 0;
+  if (queueSize > 0)
+    {
+      if (queue.init (queueSize) < 0)
+	{
+	  ulapi_socket_close (socket_fd);
+	  socket_fd = -1;
+	  return -1;
+	}
+      queue.setStatsPeriod (statsPeriod);
+      useQueue = 1;
+      publishTask = ulapi_task_new ();
+      ulapi_task_start (publishTask, publishThread, (void *) this,
+			ulapi_prio_lowest (), 1);
+    }
+
+  nh->param < bool > ("/usarsim/pipelineHandshake", pipeline, true);
+  pipelineHandshake = pipeline;
+  ROS_DEBUG ("parameter /usarsim/pipelineHandshake: %d", pipelineHandshake);
+  nh->param < double >("/usarsim/handshakeTimeout", handshakeTimeout, 1.);
+  ROS_DEBUG ("parameter /usarsim/handshakeTimeout: %f", handshakeTimeout);
+  readyPub = nh->advertise < std_msgs::Bool > ("/usarsim/ready", 1, true);
+  readyMsg.data = false;
+  readyPub.publish (readyMsg);
 
   ulapi_snprintf (str, sizeof (str),
 		  "GETSTARTPOSES\r\nINIT {Classname USARBot.%s} {Name %s} {Start %s}\r\n",
@@ -106,9 +230,7 @@ UsarsimInf::init (GenericInf * siblingIn)
      }
    */
   NULLTERM (str);
-  ulapi_mutex_take (socket_mutex);
-  usarsim_socket_write (socket_fd, str, strlen (str));
-  ulapi_mutex_give (socket_mutex);
+  writer.send (NULL, str);
 
   /*
      Note:
@@ -120,59 +242,39 @@ UsarsimInf::init (GenericInf * siblingIn)
    */
   /*ulapi_snprintf (str, sizeof (str), "GETCONF {Type Actuator}\r\n");
      NULLTERM (str);
-     ulapi_mutex_take (socket_mutex);
-     usarsim_socket_write (socket_fd, str, strlen (str));
-     ulapi_mutex_give (socket_mutex);
+     writer.send (NULL, str);
 
      ulapi_snprintf (str, sizeof (str), "GETGEO {Type Actuator}\r\n");
      NULLTERM (str);
-     ulapi_mutex_take (socket_mutex);
-     usarsim_socket_write (socket_fd, str, strlen (str));
-     ulapi_mutex_give (socket_mutex); */
+     writer.send (NULL, str); */
 
   /*
      ulapi_snprintf (str, sizeof (str), "GETCONF {Type MisPkg}\r\n");
      NULLTERM (str);
-     ulapi_mutex_take (socket_mutex);
-     usarsim_socket_write (socket_fd, str, strlen (str));
-     ulapi_mutex_give (socket_mutex);
+     writer.send (NULL, str);
 
      ulapi_snprintf (str, sizeof (str), "GETGEO {Type MisPkg}\r\n");
      NULLTERM (str);
-     ulapi_mutex_take (socket_mutex);
-     usarsim_socket_write (socket_fd, str, strlen (str));
-     ulapi_mutex_give (socket_mutex);
+     writer.send (NULL, str);
    */
 
   //  printf( "usarsiminf: Getting gripper(2) conf\n");
   /*ulapi_snprintf (str, sizeof (str), "GETCONF {Type Gripper}\r\n");
      NULLTERM (str);
-     ulapi_mutex_take (socket_mutex);
-     usarsim_socket_write (socket_fd, str, strlen (str));
-     ulapi_mutex_give (socket_mutex);
+     writer.send (NULL, str);
 
      ulapi_snprintf (str, sizeof (str), "GETGEO {Type Gripper}\r\n");
      NULLTERM (str);
-     ulapi_mutex_take (socket_mutex);
-     usarsim_socket_write (socket_fd, str, strlen (str));
-     ulapi_mutex_give (socket_mutex); */
+     writer.send (NULL, str); */
 
   //  printf( "usarsiminf: Getting rfid conf\n");
   ulapi_snprintf (str, sizeof (str), "GETCONF {Type RFID}\r\n");
   NULLTERM (str);
-  ulapi_mutex_take (socket_mutex);
-  usarsim_socket_write (socket_fd, str, strlen (str));
-  ulapi_mutex_give (socket_mutex);
+  writer.send (NULL, str);
 
   ulapi_snprintf (str, sizeof (str), "GETGEO {Type RFID}\r\n");
   NULLTERM (str);
-  ulapi_mutex_take (socket_mutex);
-  usarsim_socket_write (socket_fd, str, strlen (str));
-  ulapi_mutex_give (socket_mutex);
-
-  build = (char *) realloc (build, buildlen * sizeof (char));
-  build_ptr = build;
-  build_end = build + buildlen;
+  writer.send (NULL, str);
 
   encoders = new UsarsimList (SW_SEN_ENCODER);
   sonars = new UsarsimList (SW_SEN_SONAR);
@@ -203,17 +305,39 @@ UsarsimInf::init (GenericInf * siblingIn)
      don't know or care what type, since this will be set explicitly in
      the handleSta_xxx functions
    */
-  robot = new UsarsimList (SW_TYPE_UNINITIALIZED);
+  robot = new UsarsimComponent (SW_TYPE_UNINITIALIZED);
   robot->setName (robotName.c_str ());
-  
-  sleep (1); //sleep for a second to wait for simulator to initialize
-  
+
+  /*
+     GETCONF/GETGEO go out in this order. Toolchangers need to be done
+     before grippers, since grippers may be mounted on them.
+   */
+  encoders->setHandshake ("Encoder", 0);
+  sonars->setHandshake ("Sonar", 1);
+  rangescanners->setHandshake ("RangeScanner", 2);
+  rangeimagers->setHandshake ("RangeImager", 3);
+  touches->setHandshake ("Touch", 4);
+  co2sensors->setHandshake ("CO2Sensor", 5);
+  inses->setHandshake ("INS", 6);
+  groundtruths->setHandshake ("GroundTruth", 7);
+  gpses->setHandshake ("GPS", 8);
+  odometers->setHandshake ("Odometry", 9);
+  victims->setHandshake ("VictSensor", 10);
+  tachometers->setHandshake ("Tachometer", 11);
+  acoustics->setHandshake ("Acoustic", 12);
+  objectsensors->setHandshake ("ObjectSensor", 13);
+  misstas->setHandshake ("Actuator", 14);
+  toolchangers->setHandshake ("ToolChanger", 15);
+  grippers->setHandshake ("Gripper", 16);
+  robot->setHandshake ("Robot", 17);
+  queueHandshake (robot);
+
   ROS_INFO ("usarsim interface initialized");
   return 1;
 }
 
 int
-UsarsimInf::msgout (sw_struct * sw, componentInfo info)
+UsarsimInf::msgout (sw_struct * sw, const UsarsimCursor & info)
 {
   if (sw->name == "")
     {
@@ -224,7 +348,33 @@ UsarsimInf::msgout (sw_struct * sw, componentInfo info)
     {
       sw->time = info.time;
       sw->op = info.op;
-      sibling->peerMsg (sw);
+      if (useQueue)
+	queue.push (sw);
+      else
+	sibling->peerMsg (sw);
+    }
+  return 1;
+}
+
+/*!
+  Pass queued records to our sibling until ROS shuts down. This runs on
+  its own thread so that publishing never holds up the socket.
+*/
+int
+UsarsimInf::publish ()
+{
+  sw_struct *sw;
+
+  while (nh->ok ())
+    {
+      if (queue.wait () < 0)
+	return -1;
+      while ((sw = queue.front ()) != NULL)
+	{
+	  sibling->peerMsg (sw);
+	  queue.pop ();
+	}
+      queue.updateStats ();
     }
   return 1;
 }
@@ -239,6 +389,7 @@ UsarsimInf::peerMsg (sw_struct * swIn)
   double steerAngle, vehVel;
   double scale;
   std::string command;
+  std::string key;
   std::stringstream tempSS;
   /*
      char cmp[MAX_MSG_LEN];
@@ -316,9 +467,7 @@ UsarsimInf::peerMsg (sw_struct * swIn)
           "Drive {Left %f} {Right %f}\r\n", leftVel,
           rightVel);
           NULLTERM (str);
-          ulapi_mutex_take (socket_mutex);
-          usarsim_socket_write (socket_fd, str, strlen (str));
-          ulapi_mutex_give (socket_mutex);
+          writer.send ("Drive", str);
         }
         else if (sw->data.groundvehicle.steertype == SW_STEER_ACKERMAN)
         {
@@ -353,9 +502,7 @@ UsarsimInf::peerMsg (sw_struct * swIn)
           "Drive {Speed %f} {FrontSteer %f} {RearSteer %f}\r\n",
           vehVel, steerAngle, steerAngle);
           NULLTERM (str);
-          ulapi_mutex_take (socket_mutex);
-          usarsim_socket_write (socket_fd, str, strlen (str));
-          ulapi_mutex_give (socket_mutex);
+          writer.send ("Drive", str);
           ROS_INFO ("Wrote %s", str);
         }
         else
@@ -380,9 +527,7 @@ UsarsimInf::peerMsg (sw_struct * swIn)
       sw->data.groundvehicle.heading,
       -sw->data.groundvehicle.heading);
       NULLTERM (str);
-      ulapi_mutex_take (socket_mutex);
-      usarsim_socket_write (socket_fd, str, strlen (str));
-      ulapi_mutex_give (socket_mutex);
+      writer.send ("Drive", str);
       break;
       */
       break;
@@ -404,9 +549,8 @@ UsarsimInf::peerMsg (sw_struct * swIn)
       }
       ulapi_snprintf (str, sizeof (str), "%s\r\n", command.c_str ());
       NULLTERM (str);
-      ulapi_mutex_take (socket_mutex);
-      usarsim_socket_write (socket_fd, str, strlen (str));
-      ulapi_mutex_give (socket_mutex);
+      key = "ACT " + swIn->name;
+      writer.send (key.c_str (), str);
       break;
     }
     break;
@@ -422,11 +566,15 @@ UsarsimInf::peerMsg (sw_struct * swIn)
         "SET {Type Gripper} {Name %s} {Opcode %s}\r\n",
         swIn->name.c_str (), command.c_str ());
         NULLTERM (str);
-        usarsim_socket_write (socket_fd, str, strlen (str));
-        ulapi_mutex_give (socket_mutex);
+        key = "Gripper " + swIn->name;
+        writer.send (key.c_str (), str);
         break;
       case SW_ROS_DELETE:
-        grippers = grippers->remove(swIn->name);
+        /* the parser may be using the gripper, so it does the removing */
+        ulapi_mutex_take (interestMutex);
+        gripperDeletes.push_back (swIn->name);
+        __sync_lock_test_and_set (&deletesPending, 1);
+        ulapi_mutex_give (interestMutex);
         break;
     }
     break;
@@ -442,8 +590,8 @@ UsarsimInf::peerMsg (sw_struct * swIn)
       "SET {Type ToolChanger} {Name %s} {Opcode %s}\r\n",
       swIn->name.c_str (), command.c_str ());
       NULLTERM (str);
-      usarsim_socket_write (socket_fd, str, strlen (str));
-      ulapi_mutex_give (socket_mutex);
+      key = "ToolChanger " + swIn->name;
+      writer.send (key.c_str (), str);
       break;
     }
     break;
@@ -455,10 +603,11 @@ UsarsimInf::peerMsg (sw_struct * swIn)
       "SET {Type RangeImager} {Name %s} {Opcode SCAN}\r\n",
       swIn->name.c_str ());
       NULLTERM (str);
-      usarsim_socket_write (socket_fd, str, strlen (str));
-      ulapi_mutex_give (socket_mutex);
+      key = "RangeImager " + swIn->name;
+      writer.send (key.c_str (), str);
       break;
     }
+    break;
   default:
     ROS_ERROR ("usarsimInf::peerMsg: not handling type %s",
     swTypeToString (swIn->type));
@@ -467,10 +616,103 @@ UsarsimInf::peerMsg (sw_struct * swIn)
   return 1;
 }
 
+/*!
+  Note that someone does, or no longer does, want the bulk data of
+  component \a name of type \a type. Safe to call from any thread; the
+  parser picks the change up before its next message.
+*/
+void
+UsarsimInf::setInterest (sw_type type, const std::string & name, int wanted)
+{
+  UsarsimInterest interest;
+
+  interest.type = type;
+  interest.name = name;
+  interest.wanted = wanted;
+  ulapi_mutex_take (interestMutex);
+  interests.push_back (interest);
+  __sync_lock_test_and_set (&interestChanged, 1);
+  ulapi_mutex_give (interestMutex);
+}
+
+/*
+  Apply the interest changes made since the last call to the components
+  they name. Runs on the parser's thread, which owns the lists.
+*/
+void
+UsarsimInf::applyInterest ()
+{
+  std::list < UsarsimInterest > changes;
+  std::list < UsarsimInterest >::iterator it;
+  UsarsimList *list;
+  UsarsimComponent *where;
+
+  ulapi_mutex_take (interestMutex);
+  changes.swap (interests);
+  __sync_lock_test_and_set (&interestChanged, 0);
+  ulapi_mutex_give (interestMutex);
+
+  for (it = changes.begin (); it != changes.end (); ++it)
+    {
+      switch (it->type)
+	{
+	case SW_SEN_RANGESCANNER:
+	  list = rangescanners;
+	  break;
+	case SW_SEN_RANGEIMAGER:
+	  list = rangeimagers;
+	  break;
+	case SW_SEN_OBJECTSENSOR:
+	  list = objectsensors;
+	  break;
+	default:
+	  continue;
+	}
+      where = list->find (it->name.data (), it->name.size ());
+      if (where == NULL)
+	continue;
+      where->setWanted (it->wanted);
+      ROS_DEBUG ("%s %s data", it->wanted ? "Parsing" : "Skipping",
+		 it->name.c_str ());
+    }
+}
+
+/*
+  Remove the grippers deleted since the last call, with their handshake
+  requests. Runs on the parser's thread, between messages, so no
+  component being removed is in the middle of a parse.
+*/
+void
+UsarsimInf::applyDeletes ()
+{
+  std::list < std::string > names;
+  std::list < std::string >::iterator it;
+  UsarsimComponent *where;
+
+  ulapi_mutex_take (interestMutex);
+  names.swap (gripperDeletes);
+  __sync_lock_test_and_set (&deletesPending, 0);
+  ulapi_mutex_give (interestMutex);
+
+  for (it = names.begin (); it != names.end (); ++it)
+    {
+      where = grippers->find (it->data (), it->size ());
+      if (where != NULL)
+	dropHandshake (where);
+      grippers->remove (*it);
+    }
+}
+
+/*
+  The tokenizer never copies: keys and values come back as views into
+  the message, bounded by the delimiters. On failure the original
+  pointer is returned and the token is left unchanged.
+*/
 char *
-UsarsimInf::getKey (char *msg, char *key)
+UsarsimInf::getKey (char *msg, UsarsimToken * key)
 {
   char *ptr = msg;
+  char *start;
 
   while ((*ptr != 0) && (*ptr != '{'))
     ptr++;			/* find the {  */
@@ -480,7 +722,8 @@ UsarsimInf::getKey (char *msg, char *key)
   while (isspace (*ptr))
     ptr++;			/* skip over any space  */
 
-  /* copy everything until we hit space */
+  /* scan everything until we hit space */
+  start = ptr;
   while (1)
     {
       if ((*ptr == 0) || (*ptr == ',') || (*ptr == '{') || (*ptr == '}'))
@@ -493,24 +736,24 @@ UsarsimInf::getKey (char *msg, char *key)
 	  /* expected delimiter -- break to return current pointer */
 	  break;
 	}
-      /* else copy it */
-      *key++ = *ptr++;
+      ptr++;
     }
-  *key = 0;			/* null terminate  */
+  key->set (start, ptr);
 
   return ptr;
 }
 
 char *
-UsarsimInf::getValue (char *msg, char *token)
+UsarsimInf::getValue (char *msg, UsarsimToken * token)
 {
   char *ptr = msg;
-  char *tokenPtr = token;
+  char *start;
 
   while ((isspace (*ptr)) || (*ptr == ',') || (*ptr == '}') || (*ptr == '{'))
     ptr++;			/* skip over delimiters  */
 
-  /* copy everything until we hit a delimiter  */
+  /* scan everything until we hit a delimiter  */
+  start = ptr;
   while (!isspace (*ptr))
     {
       if (*ptr == 0)
@@ -519,30 +762,26 @@ UsarsimInf::getValue (char *msg, char *token)
 	{
 	  break;
 	}
-      /* ok to copy  */
-      *tokenPtr++ = *ptr++;
+      ptr++;
     }
-  *tokenPtr = 0;		/* null terminate  */
-  // printf( "get_value: value: %s ptr: %s\n", value, ptr );
+  token->set (start, ptr);
   return ptr;
 }
 
 int
-UsarsimInf::expect (componentInfo * info, const char *token)
+UsarsimInf::expect (UsarsimCursor * info, const char *token)
 {
-  info->nextptr = getValue (info->ptr, info->token);
+  info->nextptr = getValue (info->ptr, &info->token);
   if (info->nextptr == info->ptr)
     {
       ROS_ERROR ("EXPECT: nextptr = ptr for token %s and pointer %s",
-		 info->token, info->ptr);
+		 token, info->ptr);
       return -1;
     }
-  if (strncmp (info->token, token, strlen (token)) != 0)
+  if (!info->token.startsWith (token))
     {
-      ROS_DEBUG ("info->token(%d):%s token(%d):%s result:%d",
-		 (int) strlen (info->token), info->token,
-		 (int) strlen (token), token, strcmp (info->token, token));
-      ROS_ERROR ("EXPECT: found %s wanted %s", info->token, token);
+      ROS_ERROR ("EXPECT: found %s wanted %s",
+		 info->token.str ().c_str (), token);
       return -1;
     }
   info->ptr = info->nextptr;
@@ -550,17 +789,17 @@ UsarsimInf::expect (componentInfo * info, const char *token)
 }
 
 int
-UsarsimInf::getInteger (componentInfo * info)
+UsarsimInf::getInteger (UsarsimCursor * info)
 {
   int i;
 
-  info->nextptr = getValue (info->ptr, info->token);
+  info->nextptr = getValue (info->ptr, &info->token);
   if (info->nextptr == info->ptr)
     {
       ROS_ERROR ("Unable to find integer");
       return -1;
     }
-  if (sscanf (info->token, "%i", &i) != 1)
+  if (!info->token.toInteger (&i))
     {
       ROS_ERROR ("Unable to format integer");
       return -1;
@@ -571,17 +810,17 @@ UsarsimInf::getInteger (componentInfo * info)
 }
 
 double
-UsarsimInf::getReal (componentInfo * info)
+UsarsimInf::getReal (UsarsimCursor * info)
 {
   double d;
 
-  info->nextptr = getValue (info->ptr, info->token);
+  info->nextptr = getValue (info->ptr, &info->token);
   if (info->nextptr == info->ptr)
     {
       ROS_ERROR ("GetReal unable to find real");
       return -1;
     }
-  if (sscanf (info->token, "%lf", &d) != 1)
+  if (!info->token.toReal (&d))
     {
       ROS_ERROR ("Unable to format double for GetReal");
       return -1;
@@ -592,15 +831,15 @@ UsarsimInf::getReal (componentInfo * info)
 }
 
 void
-UsarsimInf::getTime (componentInfo * info)
+UsarsimInf::getTime (UsarsimCursor * info)
 {
-  info->nextptr = getValue (info->ptr, info->token);
+  info->nextptr = getValue (info->ptr, &info->token);
   if (info->nextptr == info->ptr)
     {
       ROS_ERROR ("GetTime unable to find time");
       return;
     }
-  if (sscanf (info->token, "%lf", &info->time) != 1)
+  if (!info->token.toReal (&info->time))
     {
       ROS_ERROR ("Unable to format double for gettime");
       return;
@@ -609,7 +848,7 @@ UsarsimInf::getTime (componentInfo * info)
 }
 
 int
-UsarsimInf::getName (UsarsimList * list, componentInfo * info, int op)
+UsarsimInf::getName (UsarsimList * list, UsarsimCursor * info, int op)
 {
   /* why?
      if (info->sawname)
@@ -619,72 +858,60 @@ UsarsimInf::getName (UsarsimList * list, componentInfo * info, int op)
      }
    */
   info->sawname = 1;
-  info->nextptr = getValue (info->ptr, info->token);
+  info->nextptr = getValue (info->ptr, &info->token);
   if (info->nextptr == info->ptr)
     return -1;
-  info->where = list->classFind (info->token);
+  info->where = list->classFind (info->token.ptr, info->token.len);
   if (info->where == NULL)
     {
       ROS_ERROR ("error from getName");
       return -1;
     }
+  if (!info->where->isQueued ())
+    queueHandshake (info->where);
   info->ptr = info->nextptr;
   return 1;
 }
 
-/* wraps socket writing with a verbose printf, for debugging */
-ulapi_integer
-  UsarsimInf::usarsim_socket_write (ulapi_integer id, char *buf,
-				    ulapi_integer len)
-{
-  ROS_DEBUG ("Sending: %s", buf);
-  return ulapi_socket_write (id, buf, len);
-}
-
+/*!
+  Read from USARSim, or the replay, and handle every complete message.
+  \return 1 on success, 0 at the end of a replay and -1 on error.
+*/
 int
 UsarsimInf::msgIn ()
 {
-  char buffer[BUFFERLEN];
-  char *buffer_ptr;
-  char *buffer_end;
-  ptrdiff_t offset;
+  char *line;
   int nchars;
   int err;
 
-  nchars = ulapi_socket_read (socket_fd, buffer, BUFFERLEN);
+  nchars = stream.fill ();
   if (nchars == -1)
     {				/* bad read */
       return -1;
     }
   if (nchars == 0)
     {				/* end of file */
+      if (stream.isReplay ())
+	{
+	  stream.logTotals ();
+	  return 0;
+	}
       return -1;
     }
-  buffer_ptr = buffer;
-  buffer_end = buffer + nchars;
 
-  while (buffer_ptr != buffer_end)
+  /* hand each complete line to the parser in place */
+  while ((line = stream.nextLine ()) != NULL)
     {
-      if (build_ptr == build_end)
-	{
-	  offset = build_ptr - build;
-	  buildlen *= 2;
-	  build = (char *) realloc (build, buildlen * sizeof (char));
-	  build_ptr = build + offset;
-	  build_end = build + buildlen;
-	}
-      *build_ptr++ = *buffer_ptr;
-      if (*buffer_ptr++ == DELIMITER)
+      if (__sync_fetch_and_add (&interestChanged, 0))
+	applyInterest ();
+      if (__sync_fetch_and_add (&deletesPending, 0))
+	applyDeletes ();
+      if ((err = handleMsg (line)) < 0)
 	{
-	  offset = build_ptr - build;
-	  build_ptr = build;
-	  build[offset] = 0;
-	  if ((err = handleMsg (build)) < 0)
-	    {
-	      ROS_ERROR ("msgIn: error(%d) handling %s", err, build);
-	    }
+	  ROS_ERROR ("msgIn: error(%d) handling %s", err, line);
 	}
     }
+  stream.updateStats ();
   return 1;
 }
 
@@ -695,9 +922,9 @@ UsarsimInf::msgIn ()
 int
 UsarsimInf::handleMsg (char *msg)
 {
-  char head[MAX_TOKEN_LEN];
+  UsarsimToken head;
   char *ptr = msg;
-  unsigned int headindex = 0;
+  char *start;
   int count;
 
   //  ROS_INFO ("incomming msg to usarsimInf: %s", msg);
@@ -707,8 +934,9 @@ UsarsimInf::handleMsg (char *msg)
   if (*ptr == 0)
     return 0;			/* blank message -- ignore */
 
-  /* copy everything until we hit space or {  */
-  for (headindex = 0; headindex < sizeof (head); headindex++)
+  /* scan everything until we hit space or {  */
+  start = ptr;
+  while (1)
     {
       if ((*ptr == 0) || (*ptr == ',') || (*ptr == '}'))
 	{
@@ -718,80 +946,64 @@ UsarsimInf::handleMsg (char *msg)
 	}
       if (isspace (*ptr) || (*ptr == '{'))
 	{
-	  /* here's the delimiter -- term the string and we're done */
-	  head[headindex] = 0;
+	  /* here's the delimiter -- we're done */
 	  break;
 	}
-      /* else copy it */
-      head[headindex] = *ptr++;
+      ptr++;
     }
+  head.set (start, ptr);
   //  ROS_DEBUG( "usarsimInf.cpp::handleMsg: socket message received: %s", msg );
-  if (!strcmp (head, "SEN"))
+  switch (head.keyword ())
     {
+    case KEY_SEN:
       count = handleSen (msg);
-    }
-  else if (!strcmp (head, "NFO"))
-    {
+      break;
+    case KEY_NFO:
       count = handleNfo (msg);
-    }
-
-  else if (!strcmp (head, "EFF"))
-    {
+      break;
+    case KEY_EFF:
       count = handleEff (msg);
-    }
-
-  else if (!strcmp (head, "STA"))
-    {
+      break;
+    case KEY_STA:
       count = handleSta (msg);
-    }
-  else if (!strcmp (head, "MISSTA") || !strcmp (head, "ASTA"))
-    {
+      break;
+    case KEY_MISSTA:
+    case KEY_ASTA:
       count = handleAsta (msg);
-    }
-  /*
-     else if (!strcmp (head, "RES"))
-     {
-     count = handleRes (msg);
-     }
-   */
-  else if (!strcmp (head, "CONF"))
-    {
+      break;
+      /*
+         case KEY_RES:
+         count = handleRes (msg);
+         break;
+       */
+    case KEY_CONF:
       ROS_INFO ("CONF: %s", msg);
       count = handleConf (msg);
-    }
-  else if (!strcmp (head, "GEO"))
-    {
+      break;
+    case KEY_GEO:
       ROS_INFO ("GEO: %s", msg);
-
       count = handleGeo (msg);
-    }
-  else
-    {
+      break;
+    default:
       ROS_ERROR ("unknown head: ``%s''", msg);
       count = handleEm (msg);
+      break;
     }
 
-  doSenConfs (encoders, (char *) "Encoder");
-  doSenConfs (sonars, (char *) "Sonar");
-  doSenConfs (rangescanners, (char *) "RangeScanner");
-  doSenConfs (rangeimagers, (char *) "RangeImager");
-  doSenConfs (touches, (char *) "Touch");
-  doSenConfs (co2sensors, (char *) "CO2Sensor");
-  doSenConfs (inses, (char *) "INS");
-  doSenConfs (groundtruths, (char *) "GroundTruth");
-  doSenConfs (gpses, (char *) "GPS");
-  doSenConfs (odometers, (char *) "Odometry");
-  doSenConfs (victims, (char *) "VictSensor");
-  doSenConfs (tachometers, (char *) "Tachometer");
-  doSenConfs (acoustics, (char *) "Acoustic");
-  doSenConfs (objectsensors, (char *) "ObjectSensor");
-  //  doSenConfs (misstas, (char *) "MisPkg");
-  doSenConfs (misstas, (char *) "Actuator");
-  //need to do toolchanger confs first if grippers are mounted on them
-  doEffConfs (toolchangers, (char *) "ToolChanger");
-  doEffConfs (grippers, (char *) "Gripper");
-
-  doRobotConfs (robot);
+  /*
+     Nothing is requested until the simulator has said something, so
+     there's no need to sleep after INIT. Once every component is
+     configured this costs nothing.
+   */
+  if (!ready)
+    {
+      if (!handshakeStarted)
+	{
+	  handshakeStarted = 1;
+	  firstMsgTime = ulapi_time ();
+	}
+      sendPending ();
+    }
 
   return count;
 }
@@ -799,7 +1011,7 @@ UsarsimInf::handleMsg (char *msg)
 int
 UsarsimInf::handleEm (char *msg)
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr = msg;
   char *nextptr = ptr;
   int count = 0;
@@ -807,23 +1019,23 @@ UsarsimInf::handleEm (char *msg)
 
   while (1)
     {
-      nextptr = getKey (ptr, &token[0]);
+      nextptr = getKey (ptr, &token);
       if (nextptr == ptr)
 	break;
-      ROS_WARN ("key %s", token);
+      ROS_WARN ("key %s", token.str ().c_str ());
       ptr = nextptr;
-      nextptr = getValue (ptr, token);
+      nextptr = getValue (ptr, &token);
       if (nextptr == ptr)
 	break;
-      ROS_WARN ("value %s", token);
+      ROS_WARN ("value %s", token.str ().c_str ());
       ptr = nextptr;
       count++;
       while (1)
 	{
-	  nextptr = getValue (ptr, token);
+	  nextptr = getValue (ptr, &token);
 	  if (nextptr == ptr)
 	    break;
-	  ROS_WARN ("value %s", token);
+	  ROS_WARN ("value %s", token.str ().c_str ());
 	  ptr = nextptr;
 	}
     }
@@ -831,124 +1043,145 @@ UsarsimInf::handleEm (char *msg)
   return count;
 }
 
-int
-UsarsimInf::doEffConfs (UsarsimList * where, char *type)
+/*
+  The CONF/GEO handshake. Each component is queued once, when getName
+  first sees it, and leaves the queues once its CONF and GEO replies
+  have been handled. Replies are matched to components by their {Type}
+  and {Name}, so with /usarsim/pipelineHandshake set every request goes
+  out at once and is only resent if its reply hasn't arrived within
+  /usarsim/handshakeTimeout seconds. Otherwise only one GETCONF and one
+  GETGEO are outstanding at a time, in queue order.
+*/
+void
+UsarsimInf::queueHandshake (UsarsimComponent * where)
+{
+  std::list < UsarsimComponent * >::iterator it;
+
+  if (where->handshakeType () == NULL)
+    return;
+  where->setQueued (1);
+  handshakeCount++;
+  for (it = pendingConfs.begin (); it != pendingConfs.end (); it++)
+    if ((*it)->handshakeRank () > where->handshakeRank ())
+      break;
+  pendingConfs.insert (it, where);
+  for (it = pendingGeos.begin (); it != pendingGeos.end (); it++)
+    if ((*it)->handshakeRank () > where->handshakeRank ())
+      break;
+  pendingGeos.insert (it, where);
+  sendPending ();
+}
+
+/* forget a component that is being deleted */
+void
+UsarsimInf::dropHandshake (UsarsimComponent * where)
+{
+  pendingConfs.remove (where);
+  pendingGeos.remove (where);
+}
+
+void
+UsarsimInf::requestHandshake (const char *request, UsarsimComponent * where)
 {
   char str[MAX_MSG_LEN];
-  sw_struct *sw;
 
-  if (NULL == where)
-    return -1;
-  sw = where->getSW ();
-  while (sw->name != "")
+  ulapi_snprintf (str, sizeof (str), "%s {Type %s} {Name %s}\r\n",
+		  request, where->handshakeType (),
+		  where->getSW ()->name.c_str ());
+  NULLTERM (str);
+  writer.send (NULL, str);
+}
+
+void
+UsarsimInf::sendHandshake (std::list < UsarsimComponent * >&pending,
+			   const char *request, int *waiting, int geo)
+{
+  std::list < UsarsimComponent * >::iterator it;
+  UsarsimComponent *where;
+  double now = ulapi_time ();
+  double sent;
+
+  it = pending.begin ();
+  while (it != pending.end ())
     {
-      if (!where->didConf () && !waitingForConf)
+      where = *it;
+      if (geo ? where->didGeo () : where->didConf ())
 	{
-	  ulapi_snprintf (str, sizeof (str),
-			  "GETCONF {Type %s} {Name %s}\r\n", type,
-			  sw->name.c_str ());
-	  NULLTERM (str);
-	  ulapi_mutex_take (socket_mutex);
-	  usarsim_socket_write (socket_fd, str, strlen (str));
-	  ulapi_mutex_give (socket_mutex);
-	  waitingForConf = 1;
-	  ROS_DEBUG ("usarsiminf: (2) waitingForConf set \n");
+	  it = pending.erase (it);
+	  continue;
 	}
-      else if (!where->didGeo () && !waitingForGeo)
+      if (!pipelineHandshake)
 	{
-	  ulapi_snprintf (str, sizeof (str), "GETGEO {Type %s} {Name %s}\r\n",
-			  type, sw->name.c_str ());
-	  NULLTERM (str);
-	  ulapi_mutex_take (socket_mutex);
-	  usarsim_socket_write (socket_fd, str, strlen (str));
-	  ulapi_mutex_give (socket_mutex);
-	  ROS_DEBUG ("waitingForGeo set (1)");
-	  waitingForGeo = 1;
+	  if (!*waiting)
+	    {
+	      requestHandshake (request, where);
+	      *waiting = 1;
+	      ROS_DEBUG ("%s set", geo ? "waitingForGeo" : "waitingForConf");
+	    }
+	  return;
+	}
+      sent = geo ? where->geoRequested () : where->confRequested ();
+      if (sent == 0 || now - sent > handshakeTimeout)
+	{
+	  if (sent != 0)
+	    ROS_WARN ("no %s reply for %s %s, asking again",
+		      geo ? "GEO" : "CONF", where->handshakeType (),
+		      where->getSW ()->name.c_str ());
+	  requestHandshake (request, where);
+	  if (geo)
+	    where->setGeoRequested (now);
+	  else
+	    where->setConfRequested (now);
 	}
-      where = where->getNext ();
-      sw = where->getSW ();
+      it++;
     }
-
-  return 0;
 }
 
-int
-UsarsimInf::doRobotConfs (UsarsimList * where)
+void
+UsarsimInf::sendPending ()
 {
-  char str[MAX_MSG_LEN];
-  sw_struct *sw;
-
-  if (where == NULL)
-    return -1;
-  sw = where->getSW ();
-  if (!where->didConf () && !waitingForConf)
-    {
-      ulapi_snprintf (str, sizeof (str), "GETCONF {Type Robot} {Name %s}\r\n",
-		      sw->name.c_str ());
-      NULLTERM (str);
-      ulapi_mutex_take (socket_mutex);
-      usarsim_socket_write (socket_fd, str, strlen (str));
-      ulapi_mutex_give (socket_mutex);
-      waitingForConf = 1;
-      ROS_DEBUG ("usarsiminf: (3) waitingForConf set \n");
-    }
-  else if (!where->didGeo () && !waitingForGeo)
-    {
-      ulapi_snprintf (str, sizeof (str), "GETGEO {Type Robot} {Name %s}\r\n",
-		      sw->name.c_str ());
-      NULLTERM (str);
-      ulapi_mutex_take (socket_mutex);
-      usarsim_socket_write (socket_fd, str, strlen (str));
-      ulapi_mutex_give (socket_mutex);
-      ROS_DEBUG ("waitingForGeo set (2)");
-      waitingForGeo = 1;
-    }
+  if (!handshakeStarted)
+    return;
+  sendHandshake (pendingConfs, "GETCONF", &waitingForConf, 0);
+  sendHandshake (pendingGeos, "GETGEO", &waitingForGeo, 1);
+  setReady (pendingConfs.empty () && pendingGeos.empty ());
+}
 
-  return 0;
+/*
+  Publish from the socket thread even if a queue size is set. Must be
+  called before init().
+*/
+void
+UsarsimInf::setSynchronous ()
+{
+  synchronous = 1;
 }
 
-int
-UsarsimInf::doSenConfs (UsarsimList * where, char *type)
+/* publish readiness on /usarsim/ready whenever it changes */
+void
+UsarsimInf::setReady (int value)
 {
-  char str[MAX_MSG_LEN];
-  sw_struct *sw;
-  if (where == NULL)
-    return -1;
+  std_msgs::Bool msg;
+  double now;
 
-  sw = where->getSW ();
-  while (sw->name != "")
+  if (value == ready)
+    return;
+  if (value)
     {
-      if (!where->didConf () && !waitingForConf)
-	{
-	  ulapi_snprintf (str, sizeof (str),
-			  "GETCONF {Type %s} {Name %s}\r\n", type,
-			  sw->name.c_str ());
-	  NULLTERM (str);
-	  ulapi_mutex_take (socket_mutex);
-	  usarsim_socket_write (socket_fd, str, strlen (str));
-	  ulapi_mutex_give (socket_mutex);
-	  waitingForConf = 1;
-	  ROS_DEBUG ("usarsiminf: (1) waitingForConf set \n");
-	}
-      else if (!where->didGeo () && !waitingForGeo)
-	{
-	  ulapi_snprintf (str, sizeof (str), "GETGEO {Type %s} {Name %s}\r\n",
-			  type, sw->name.c_str ());
-	  NULLTERM (str);
-	  ulapi_mutex_take (socket_mutex);
-	  usarsim_socket_write (socket_fd, str, strlen (str));
-	  ulapi_mutex_give (socket_mutex);
-	  ROS_DEBUG ("waitingForGeo set (3)");
-	  waitingForGeo = 1;
-	}
-      where = where->getNext ();
-      sw = where->getSW ();
+      now = ulapi_time ();
+      ROS_INFO ("usarsim interface ready: %d components configured "
+		"%.3f s after init, %.3f s after first message",
+		handshakeCount, now - initTime, now - firstMsgTime);
     }
-  return 0;
+  else
+    ROS_INFO ("usarsim interface not ready: configuring new component");
+  ready = value;
+  msg.data = value;
+  readyPub.publish (msg);
 }
 
 void
-UsarsimInf::setComponentInfo (char *msg, componentInfo * info)
+UsarsimInf::setCursor (char *msg, UsarsimCursor * info)
 {
   info->ptr = msg;
   info->sawname = 0;
@@ -970,9 +1203,9 @@ UsarsimInf::setComponentInfo (char *msg, componentInfo * info)
 int
 UsarsimInf::handleStaGroundvehicle (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw;
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   static int didError = 0;
 
   /* since we only have one robot, we just set it explicitly here
@@ -992,23 +1225,23 @@ UsarsimInf::handleStaGroundvehicle (char *msg)
     }
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GroundVehicle");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry  
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1027,9 +1260,9 @@ UsarsimInf::handleStaGroundvehicle (char *msg)
 int
 UsarsimInf::handleStaBasemachine (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw;
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   info.where = robot;
   sw = info.where->getSW ();
@@ -1037,23 +1270,23 @@ UsarsimInf::handleStaBasemachine (char *msg)
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "BaseMachine");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.op = SW_DEVICE_STAT;
@@ -1079,32 +1312,32 @@ UsarsimInf::handleStaBasemachine (char *msg)
 int
 UsarsimInf::handleStaStaticplatform (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   info.where = robot;
   sw->type = SW_ROBOT_FIXED;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "StaticPlatform");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry  
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.op = SW_DEVICE_STAT;
@@ -1116,40 +1349,36 @@ UsarsimInf::handleStaStaticplatform (char *msg)
 int
 UsarsimInf::handleSta (char *msg)
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr = msg;
   char *nextptr;
   int count = 0;
 
   while (1)
     {
-      nextptr = getKey (ptr, &token[0]);
+      nextptr = getKey (ptr, &token);
       if (nextptr == ptr)
 	break;
       ptr = nextptr;
 
       // look for {Type <name>}, and pass the whole msg to the STA 
-      if (!strcmp (token, "Type"))
+      if (token.is ("Type"))
 	{
-	  nextptr = getValue (ptr, token);
+	  nextptr = getValue (ptr, &token);
 	  if (nextptr == ptr)
 	    return -1;
-	  if (!strcmp (token, "GroundVehicle"))
+	  switch (token.keyword ())
 	    {
+	    case KEY_GroundVehicle:
 	      return handleStaGroundvehicle (msg);
-	    }
-	  else if (!strcmp (token, "BaseMachine"))
-	    {
+	    case KEY_BaseMachine:
 	      return handleStaBasemachine (msg);
-	    }
-	  else if (!strcmp (token, "StaticPlatform"))
-	    {
+	    case KEY_StaticPlatform:
 	      return handleStaStaticplatform (msg);
-	    }
-	  else
-	    {
-	      ROS_ERROR ("Unknown STA type %s", token);
+	    default:
+	      ROS_ERROR ("Unknown STA type %s", token.str ().c_str ());
 	      // skip it and keep going 
+	      break;
 	    }
 	}
       // else something else, probably {Time #} 
@@ -1181,91 +1410,75 @@ int
 UsarsimInf::handleSenRangeimager (char *msg)
 {
 
-  componentInfo info;;
+  UsarsimCursor info;
   int number;
+  int dropped;
   sw_struct *sw = rangeimagers->getSW ();
-  float f;
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   number = 0;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "RangeImager");
-	}
-      else if (!strcmp (info.token, "Frame"))
-	{
+	  break;
+	case KEY_Frame:
 	  sw->data.rangeimager.frame = getInteger (&info);
-	}
-      else if (!strcmp (info.token, "Frames"))
-	{
+	  break;
+	case KEY_Frames:
 	  sw->data.rangeimager.totalframes = getInteger (&info);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (rangeimagers, &info, SW_SEN_RANGEIMAGER_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Resolution"))
-	{
+	  break;
+	case KEY_Resolution:
 	  sw->data.rangeimager.resolutionx = getReal (&info);
 	  sw->data.rangeimager.resolutiony = getReal (&info);
-	}
-      else if (!strcmp (info.token, "FOV"))
-	{
+	  break;
+	case KEY_FOV:
 	  sw->data.rangeimager.fovx = getReal (&info);
 	  sw->data.rangeimager.fovy = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Range"))
-	{
+	  break;
+	case KEY_Range:
+	  if (!info.where->isWanted ())
+	    {
+	      /* nobody subscribes, so step over the values unread */
+	      info.ptr = (char *) usarsimSkipValue (info.ptr);
+	      info.count++;
+	      break;
+	    }
 	  /*
-	     We won't use the usual GET_REAL macro to get range values,
-	     since there are a bunch separated by commas, and we'll also
-	     want to keep track of the cumulative number.
+	     Range values are a comma separated list, parsed in one pass
+	     straight into the frame rather than token by token.
 	   */
-	  while (1)
-	    {
-	      info.nextptr = getValue (info.ptr, info.token);
-	      if (info.nextptr == info.ptr)
-		{
-		  if (number == 0)
-		    return -1;	// need at least one range value
-		  else
-		    break;
-		}
-	      if (sscanf (info.token, "%f", &f) != 1)
-		return -1;
-	      if (number >= SW_SEN_RANGEIMAGER_MAX)
-		{
-		  // drop it 
-		  ROS_WARN ("rangeimager warning, dropping data");
-		}
-	      else
-		{
-		  sw->data.rangeimager.range[number] = f;
-		  number++;
-		}
-	      info.ptr = info.nextptr;
-	    }
+	  info.nextptr = (char *)
+	    usarsimParseRealList (info.ptr, sw->data.rangeimager.range,
+				  SW_SEN_RANGEIMAGER_MAX, &number, &dropped);
+	  if (info.nextptr == NULL || number == 0)
+	    return -1;		// need at least one range value
+	  if (dropped > 0)
+	    ROS_WARN ("rangeimager warning, dropping %d values", dropped);
+	  info.ptr = info.nextptr;
 	  // all ok, so credit the count
 	  info.count++;
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   sw->data.rangeimager.numberperframe = number;
@@ -1284,24 +1497,24 @@ UsarsimInf::handleSenRangeimager (char *msg)
 int
 UsarsimInf::handleSenTouch (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw = touches->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Touch");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (touches, &info, SW_SEN_TOUCH_STAT);
 	  sw = info.where->getSW ();
 	  /* FIXME -- conf and geo are not handled inside usarsim */
@@ -1309,23 +1522,23 @@ UsarsimInf::handleSenTouch (char *msg)
 	  info.where->setDidGeo (1);
 	  expect (&info, "Touch");
 	  /* expecting "True" or "False" */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (!strcmp (info.token, "False"))
+	  if (info.token.is ("False"))
 	    sw->data.touch.touched = 0;
-	  else if (!strcmp (info.token, "True"))
+	  else if (info.token.is ("True"))
 	    sw->data.touch.touched = 1;
 	  else
 	    return -1;
 	  info.ptr = info.nextptr;
 	  /* all ok, so credit the count */
 	  info.count++;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1343,42 +1556,40 @@ UsarsimInf::handleSenTouch (char *msg)
 int
 UsarsimInf::handleSenCo2sensor (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw = co2sensors->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "CO2Sensor");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (co2sensors, &info, SW_SEN_CO2_STAT);
 	  sw = info.where->getSW ();
 	  /* FIXME -- conf and geo are not handled inside usarsim */
 	  info.where->setDidGeo (1);
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "Gas"))
-	{
+	  break;
+	case KEY_Gas:
 	  expect (&info, "CO2");
-	}
-      else if (!strcmp (info.token, "Density"))
-	{
+	  break;
+	case KEY_Density:
 	  sw->data.co2sensor.density = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1395,47 +1606,44 @@ UsarsimInf::handleSenCo2sensor (char *msg)
 int
 UsarsimInf::handleSenGroundtruth (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw = inses->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GroundTruth");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (groundtruths, &info, SW_SEN_GROUNDTRUTH_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Location"))
-	{
+	  break;
+	case KEY_Location:
 	  sw->data.groundtruth.position.x = getReal (&info);
 	  sw->data.groundtruth.position.y = getReal (&info);
 	  sw->data.groundtruth.position.z = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Orientation"))
-	{
+	  break;
+	case KEY_Orientation:
 	  sw->data.groundtruth.position.roll = getReal (&info);
 	  sw->data.groundtruth.position.pitch = getReal (&info);
 	  sw->data.groundtruth.position.yaw = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	// skip unknown entry 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1454,7 +1662,7 @@ UsarsimInf::handleSenGroundtruth (char *msg)
 int
 UsarsimInf::handleSenGps (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   double latdeg;
   double latmin;
   double londeg;
@@ -1463,70 +1671,66 @@ UsarsimInf::handleSenGps (char *msg)
   int west = 0;
   sw_struct *sw = gpses->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   latdeg = londeg = latmin = lonmin = 0;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GPS");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (gpses, &info, SW_SEN_GPS_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Latitude"))
-	{
+	  break;
+	case KEY_Latitude:
 	  latdeg = getReal (&info);
 	  latmin = getReal (&info);
 	  /* this is too specific to define convenience macro */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if ('N' == info.token[0])
+	  if (info.token.startsWith ("N"))
 	    south = 0;
-	  else if ('S' == info.token[0])
+	  else if (info.token.startsWith ("S"))
 	    south = 1;
 	  else
 	    return -1;
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Longitude"))
-	{
+	  break;
+	case KEY_Longitude:
 	  londeg = getReal (&info);
 	  lonmin = getReal (&info);
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if ('E' == info.token[0])
+	  if (info.token.startsWith ("E"))
 	    west = 0;
-	  else if ('W' == info.token[0])
+	  else if (info.token.startsWith ("W"))
 	    west = 1;
 	  else
 	    return -1;
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Fix"))
-	{
+	  break;
+	case KEY_Fix:
 	  sw->data.gps.fix = getInteger (&info);
-	}
-      else if (!strcmp (info.token, "Satellites"))
-	{
+	  break;
+	case KEY_Satellites:
 	  sw->data.gps.satellites = getInteger (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1552,11 +1756,11 @@ UsarsimInf::handleSenGps (char *msg)
 int
 UsarsimInf::handleSenIns (char *msg, const char *sensorType)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw;
   UsarsimList *myList;
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   if (!strcmp (sensorType, "INS"))
     myList = inses;
@@ -1572,40 +1776,37 @@ UsarsimInf::handleSenIns (char *msg, const char *sensorType)
   sw = myList->getSW ();
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, sensorType);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (myList, &info, SW_SEN_INS_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Location"))
-	{
+	  break;
+	case KEY_Location:
 	  sw->data.ins.position.x = getReal (&info);
 	  sw->data.ins.position.y = getReal (&info);
 	  sw->data.ins.position.z = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Orientation"))
-	{
+	  break;
+	case KEY_Orientation:
 	  sw->data.ins.position.roll = getReal (&info);
 	  sw->data.ins.position.pitch = getReal (&info);
 	  sw->data.ins.position.yaw = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1625,44 +1826,42 @@ UsarsimInf::handleSenIns (char *msg, const char *sensorType)
 int
 UsarsimInf::handleSenOdometry (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw = odometers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Odometry");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (odometers, &info, SW_SEN_ODOMETER_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Pose"))
-	{
+	  break;
+	case KEY_Pose:
 	  sw->data.odometer.position.x = getReal (&info);
 	  sw->data.odometer.position.y = getReal (&info);
 	  sw->data.odometer.position.yaw = getReal (&info);
 	  sw->data.odometer.position.roll = 0;
 	  sw->data.odometer.position.pitch = 0;
 	  sw->data.odometer.position.z = 0;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1681,10 +1880,10 @@ UsarsimInf::handleSenOdometry (char *msg)
 int
 UsarsimInf::handleSenVictim (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   //  sw_struct *sw = victims->getSW();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   ROS_WARN ("Victim sensor not working");
   return 0;
@@ -1696,27 +1895,27 @@ UsarsimInf::handleSenVictim (char *msg)
 
      while (1)
      {
-     info.nextptr = getKey (info.ptr, info.token);
+     info.nextptr = getKey (info.ptr, &info.token);
      if (info.nextptr == info.ptr)
      break;
      info.ptr = info.nextptr;
 
-     if (!strcmp (info.token, "Type"))
+     if (info.token.is ("Type"))
      {
      expect (&info, "VictSensor");
      }
-     else if (!strcmp (info.token, "Time"))
+     else if (info.token.is ("Time"))
      {
      getTime (&info);
      }
-     else if (!strcmp (info.token, "Status"))
+     else if (info.token.is ("Status"))
      {
-     info.nextptr = getValue (info.ptr, info.token);
+     info.nextptr = getValue (info.ptr, &info.token);
      if (info.nextptr == info.ptr)
      return -1;
-     if (!strcmp (info.token, "Victims"))
+     if (info.token.is ("Victims"))
      sw->data.victim.victims = 1;
-     else if (!strcmp (info.token, "NoVictims"))
+     else if (info.token.is ("NoVictims"))
      sw->data.victim.victims = 0;
      else
      return -1;
@@ -1727,7 +1926,7 @@ UsarsimInf::handleSenVictim (char *msg)
      else
      {
      // skip unknown entry 
-     info.nextptr = getValue (info.ptr, info.token);
+     info.nextptr = getValue (info.ptr, &info.token);
      }
      }
 
@@ -1745,32 +1944,31 @@ UsarsimInf::handleSenVictim (char *msg)
 int
 UsarsimInf::handleSenTachometer (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   int vel_number = 0;
   int pos_number = 0;
   sw_struct *sw = tachometers->getSW ();
   double d;
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Tachometer");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (tachometers, &info, SW_SEN_TACHOMETER_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Vel"))
-	{
+	  break;
+	case KEY_Vel:
 	  /*
 	     We won't use the usual GET_REAL macro to get range values,
 	     since there are a bunch separated by commas, and we'll also
@@ -1778,7 +1976,7 @@ UsarsimInf::handleSenTachometer (char *msg)
 	   */
 	  while (1)
 	    {
-	      info.nextptr = getValue (info.ptr, info.token);
+	      info.nextptr = getValue (info.ptr, &info.token);
 	      if (info.nextptr == info.ptr)
 		{
 		  if (vel_number == 0)
@@ -1789,7 +1987,7 @@ UsarsimInf::handleSenTachometer (char *msg)
 		  else
 		    break;
 		}
-	      if (sscanf (info.token, "%lf", &d) != 1)
+	      if (!info.token.toReal (&d))
 		{
 		  // this should only happen if we are done reading positions
 		  if (vel_number == 0)
@@ -1811,12 +2009,11 @@ UsarsimInf::handleSenTachometer (char *msg)
 		}
 	      info.ptr = info.nextptr;
 	    }
-	}
-      else if (!strcmp (info.token, "Pos"))
-	{
+	  break;
+	case KEY_Pos:
 	  while (1)
 	    {
-	      info.nextptr = getValue (info.ptr, info.token);
+	      info.nextptr = getValue (info.ptr, &info.token);
 	      if (info.nextptr == info.ptr)
 		{
 		  if (pos_number == 0)
@@ -1827,7 +2024,7 @@ UsarsimInf::handleSenTachometer (char *msg)
 		  else
 		    break;
 		}
-	      if (sscanf (info.token, "%lf", &d) != 1)
+	      if (!info.token.toReal (&d))
 		{
 		  // this should only happen if we are done reading positions
 		  if (pos_number == 0)
@@ -1852,17 +2049,16 @@ UsarsimInf::handleSenTachometer (char *msg)
 	    }
 	  /* credit the count here, after the last expected data type 'Pos' */
 	  info.count++;
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  ROS_WARN ("Unknown key in tach: %s value: %s",
-		    info.token, info.nextptr);
+		    info.token.str ().c_str (), info.nextptr);
+	  break;
 	}
     }
 
@@ -1886,53 +2082,49 @@ UsarsimInf::handleSenTachometer (char *msg)
 int
 UsarsimInf::handleSenAcoustic (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   double x, y, z;
   sw_struct *sw = acoustics->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Acoustic");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (acoustics, &info, SW_SEN_ACOUSTIC_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Direction"))
-	{
+	  break;
+	case KEY_Direction:
 	  x = getReal (&info);
 	  y = getReal (&info);
 	  z = getReal (&info);
 	  sw->data.acoustic.azimuth = atan2 (y, x);
 	  sw->data.acoustic.altitude = atan2 (z, sqrt (x * x + y * y));
-	}
-      else if (!strcmp (info.token, "Volume"))
-	{
+	  break;
+	case KEY_Volume:
 	  sw->data.acoustic.volume = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Duration"))
-	{
+	  break;
+	case KEY_Duration:
 	  sw->data.acoustic.duration = getReal (&info);
 	  /* ignore "Delay" since that's not obtainable by a real sensor */
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -1951,10 +2143,10 @@ UsarsimInf::handleSenAcoustic (char *msg)
 int
 UsarsimInf::handleSenEncoder (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw = encoders->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   /*
      NOTE -- the 'where' pointer doesn't get set until "Name" is seen,
@@ -1969,32 +2161,30 @@ UsarsimInf::handleSenEncoder (char *msg)
    */
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
       sw = info.where->getSW ();
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Encoder");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (encoders, &info, SW_SEN_ENCODER_STAT);
-	}
-      else if (!strcmp (info.token, "Tick"))
-	{
+	  break;
+	case KEY_Tick:
 	  sw->data.encoder.tick = getInteger (&info);
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.op = SW_SEN_ENCODER_STAT;
@@ -2011,37 +2201,36 @@ UsarsimInf::handleSenEncoder (char *msg)
 int
 UsarsimInf::handleSenSonar (char *msg)
 {
-  componentInfo info;;
+  UsarsimCursor info;;
   sw_struct *sw = sonars->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Sonar");
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (sonars, &info, SW_SEN_SONAR_STAT);
 	  sw = info.where->getSW ();
 	  expect (&info, "Range");
 	  sw->data.sonar.range = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2060,78 +2249,77 @@ UsarsimInf::handleSenSonar (char *msg)
 int
 UsarsimInf::handleSenRangescanner (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = rangescanners->getSW ();
-  double d;
+  int dropped;
 
   int number = 0;
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "RangeScanner");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (rangescanners, &info, SW_SEN_RANGESCANNER_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Resolution"))
-	{
+	  break;
+	case KEY_Resolution:
 	  sw->data.rangescanner.resolution = getReal (&info);
-	}
-      else if (!strcmp (info.token, "FOV"))
-	{
+	  break;
+	case KEY_FOV:
 	  sw->data.rangescanner.fov = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Range"))
-	{
+	  break;
+	case KEY_Range:
+	  if (!info.where->isWanted ())
+	    {
+	      /* nobody subscribes, so step over the values unread */
+	      info.ptr = (char *) usarsimSkipValue (info.ptr);
+	      info.count++;
+	      break;
+	    }
 	  /*
-	     We won't use the usual GET_REAL macro to get range values,
-	     since there are a bunch separated by commas, and we'll also
-	     want to keep track of the cumulative number.
+	     Range values are a comma separated list, parsed in one pass
+	     straight into the scan rather than token by token. If the
+	     scan is bigger than any before it the buffer grows to fit and
+	     the list is parsed again, so nothing is dropped.
 	   */
-	  while (1)
+	  info.nextptr = (char *)
+	    usarsimParseRealList (info.ptr, sw->data.rangescanner.range,
+				  sw->data.rangescanner.capacity, &number,
+				  &dropped);
+	  if (info.nextptr != NULL && dropped > 0)
 	    {
-	      info.nextptr = getValue (info.ptr, info.token);
-	      if (info.nextptr == info.ptr)
-		{
-		  if (number == 0)
-		    return -1;	// need at least one range value 
-		  else
-		    break;
-		}
-	      if (sscanf (info.token, "%lf", &d) != 1)
-		return -1;
-	      if (number >= SW_SEN_RANGESCANNER_MAX)
-		{
-		  // drop it 
-		}
-	      else
-		{
-		  sw->data.rangescanner.range[number] = d;
-		  number++;
-		}
-	      info.ptr = info.nextptr;
+	      delete[]sw->data.rangescanner.range;
+	      sw->data.rangescanner.capacity = number + dropped;
+	      sw->data.rangescanner.range =
+		new float[sw->data.rangescanner.capacity];
+	      info.nextptr = (char *)
+		usarsimParseRealList (info.ptr, sw->data.rangescanner.range,
+				      sw->data.rangescanner.capacity, &number,
+				      &dropped);
 	    }
+	  if (info.nextptr == NULL || number == 0)
+	    return -1;		// need at least one range value
+	  info.ptr = info.nextptr;
 	  // all ok, so credit the count
 	  info.count++;
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry  
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2142,94 +2330,134 @@ UsarsimInf::handleSenRangescanner (char *msg)
   return info.count;
 }
 
+/*
+  Find the name \a token in \a pool, adding it the first time it is
+  seen. A sensor tends to report the same objects in the same order,
+  so \a hint, what this entry held last time, is checked first and
+  then nothing needs allocating.
+*/
+static const std::string *
+internName (sw_name_pool * pool, const UsarsimToken & token,
+	    const std::string * hint)
+{
+  if (hint != NULL && token.is (hint->c_str ()))
+    return hint;
+  return &*pool->insert (token.str ()).first;
+}
+
+/*
+  Start \a os's name pool over once it has collected more names than
+  any one message needs, as it does in worlds that keep spawning parts
+  with new names. The objects' names pointed into it, so they go too.
+*/
+static void
+trimNames (sw_sen_objectsensor_struct * os)
+{
+  if (os->names->size () <= SW_NAME_POOL_MAX)
+    return;
+  os->names->clear ();
+  for (int i = 0; i < os->capacity; i++)
+    os->objects[i].tag = os->objects[i].material_name = NULL;
+}
+
+/* double the room for objects, keeping the ones already there */
+static void
+growObjects (sw_sen_objectsensor_struct * os)
+{
+  sw_sen_object_struct *objects =
+    new sw_sen_object_struct[2 * os->capacity] ();
+
+  memcpy (objects, os->objects, os->capacity * sizeof (*objects));
+  delete[]os->objects;
+  os->objects = objects;
+  os->capacity *= 2;
+}
+
 int
 UsarsimInf::handleSenObjectSensor (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = objectsensors->getSW ();
+  sw_sen_object_struct *object = NULL;
   int objectIndex = -1;
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "ObjectSensor");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (objectsensors, &info, SW_SEN_OBJECTSENSOR_STAT);
 	  sw = info.where->getSW ();
+	  trimNames (&sw->data.objectsensor);
+	  object = NULL;
 	  objectIndex = -1;
-	}
-      else if (!strcmp (info.token, "Time"))
-	{
+	  break;
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Object"))
-	{
-	  objectIndex++;
-	  if (objectIndex >= SW_SEN_RANGESCANNER_MAX)
+	  break;
+	case KEY_Object:
+	  if (!info.where->isWanted ())
 	    {
+	      /* the objects end the message; nobody subscribes to them */
+	      info.ptr += strlen (info.ptr);
+	      break;
 	    }
-	  else
-	    {
-	      info.nextptr = getValue (info.ptr, info.token);
-	      if (info.nextptr == info.ptr)
-		return -1;
-	      strcpy (sw->data.objectsensor.objects[objectIndex].tag,
-		      info.token);
-	    }
-	}
-      else if (!strcmp (info.token, "Location"))
-	{
-	  if (objectIndex < 0)
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->data.objectsensor.objects[objectIndex].position.x =
-	    getReal (&info);
-	  sw->data.objectsensor.objects[objectIndex].position.y =
-	    getReal (&info);
-	  sw->data.objectsensor.objects[objectIndex].position.z =
-	    getReal (&info);
-	}
-      else if (!strcmp (info.token, "Orientation"))
-	{
-	  if (objectIndex < 0)
+	  objectIndex++;
+	  if (objectIndex >= sw->data.objectsensor.capacity)
+	    growObjects (&sw->data.objectsensor);
+	  object = &sw->data.objectsensor.objects[objectIndex];
+	  object->tag = internName (sw->data.objectsensor.names, info.token,
+				    object->tag);
+	  object->material_name = internName (sw->data.objectsensor.names,
+					      UsarsimToken (),
+					      object->material_name);
+	  break;
+	case KEY_Location:
+	  if (object == NULL)
 	    return -1;
-	  sw->data.objectsensor.objects[objectIndex].position.roll =
-	    getReal (&info);
-	  sw->data.objectsensor.objects[objectIndex].position.pitch =
-	    getReal (&info);
-	  sw->data.objectsensor.objects[objectIndex].position.yaw =
-	    getReal (&info);
-	}
-      else if (!strcmp (info.token, "HitLoc"))
-	{
-	  if (objectIndex < 0)
+	  object->position.x = getReal (&info);
+	  object->position.y = getReal (&info);
+	  object->position.z = getReal (&info);
+	  break;
+	case KEY_Orientation:
+	  if (object == NULL)
 	    return -1;
-	  sw->data.objectsensor.objects[objectIndex].hit_location.x =
-	    getReal (&info);
-	  sw->data.objectsensor.objects[objectIndex].hit_location.y =
-	    getReal (&info);
-	  sw->data.objectsensor.objects[objectIndex].hit_location.z =
-	    getReal (&info);
-	}
-      else if (!strcmp (info.token, "Material"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  object->position.roll = getReal (&info);
+	  object->position.pitch = getReal (&info);
+	  object->position.yaw = getReal (&info);
+	  break;
+	case KEY_HitLoc:
+	  if (object == NULL)
+	    return -1;
+	  object->hit_location.x = getReal (&info);
+	  object->hit_location.y = getReal (&info);
+	  object->hit_location.z = getReal (&info);
+	  break;
+	case KEY_Material:
+	  if (object == NULL)
+	    return -1;
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  strcpy (sw->data.objectsensor.objects[objectIndex].material_name,
-		  info.token);
-	}
-      else
-	{
+	  object->material_name = internName (sw->data.objectsensor.names,
+					      info.token,
+					      object->material_name);
+	  break;
+	default:
 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   sw->data.objectsensor.number = objectIndex + 1;
@@ -2242,88 +2470,60 @@ UsarsimInf::handleSenObjectSensor (char *msg)
 int
 UsarsimInf::handleSen (char *msg)
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr = msg;
   char *nextptr;
   int count = 0;
 
   while (1)
     {
-      nextptr = getKey (ptr, token);
+      nextptr = getKey (ptr, &token);
       if (nextptr == ptr)
 	break;
       ptr = nextptr;
 
       /* look for {Type <name>}, and pass the whole msg to the sensor */
-      if (!strcmp (token, "Type"))
+      if (token.is ("Type"))
 	{
-	  nextptr = getValue (ptr, token);
+	  nextptr = getValue (ptr, &token);
 	  if (nextptr == ptr)
 	    return -1;
-	  if (!strcmp (token, "Sonar"))
+	  switch (token.keyword ())
 	    {
+	    case KEY_Sonar:
 	      return handleSenSonar (msg);
-	    }
-	  else if (!strcmp (token, "RangeScanner"))
-	    {
+	    case KEY_RangeScanner:
 	      return handleSenRangescanner (msg);
-	    }
-	  else if (!strcmp (token, "RangeImager"))
-	    {
+	    case KEY_RangeImager:
 	      return handleSenRangeimager (msg);
-	    }
-	  if (!strcmp (token, "Encoder"))
-	    {
+	    case KEY_Encoder:
 	      return handleSenEncoder (msg);
-	    }
-	  else if (!strcmp (token, "Touch"))
-	    {
+	    case KEY_Touch:
 	      return handleSenTouch (msg);
-	    }
-	  else if (!strcmp (token, "CO2Sensor"))
-	    {
+	    case KEY_CO2Sensor:
 	      return handleSenCo2sensor (msg);
-	    }
-	  else if (!strcmp (token, "GroundTruth"))
-	    {
+	    case KEY_GroundTruth:
 	      return handleSenIns (msg, "GroundTruth");
-	    }
-	  else if (!strcmp (token, "GPS"))
-	    {
+	    case KEY_GPS:
 	      return handleSenGps (msg);
-	    }
-	  else if (!strcmp (token, "INS"))
-	    {
+	    case KEY_INS:
 	      return handleSenIns (msg, "INS");
-	    }
-	  else if (!strcmp (token, "Odometry"))
-	    {
+	    case KEY_Odometry:
 	      return handleSenOdometry (msg);
-	    }
-	  else if (!strcmp (token, "VictSensor"))
-	    {
+	    case KEY_VictSensor:
 	      return handleSenVictim (msg);
-	    }
-	  else if (!strcmp (token, "Tachometer"))
-	    {
+	    case KEY_Tachometer:
 	      return handleSenTachometer (msg);
-	    }
-	  else if (!strcmp (token, "Acoustic"))
-	    {
+	    case KEY_Acoustic:
 	      return handleSenAcoustic (msg);
-	    }
-	  else if (!strcmp (token, "ObjectSensor"))
-	    {
+	    case KEY_ObjectSensor:
 	      return handleSenObjectSensor (msg);
-	    }
-	  else if (!strcmp (token, "Camera"))
-	    {
+	    case KEY_Camera:
 	      return count;
-	    }
-	  else
-	    {
-	      ROS_ERROR ("Unknown sensor type %s", token);
+	    default:
+	      ROS_ERROR ("Unknown sensor type %s", token.str ().c_str ());
 	      /* skip it and keep going */
+	      break;
 	    }
 	}
       /* else something else to be handled by sensor, probably {Time #} */
@@ -2338,37 +2538,35 @@ UsarsimInf::handleSen (char *msg)
 int
 UsarsimInf::handleConfEncoder (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = encoders->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Encoder");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (encoders, &info, SW_SEN_ENCODER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-
-	}
-      else if (!strcmp (info.token, "Resolution"))
-	{
+	  break;
+	case KEY_Resolution:
 	  sw->data.encoder.resolution = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.where->setDidConf (1);
@@ -2384,44 +2582,41 @@ UsarsimInf::handleConfEncoder (char *msg)
 int
 UsarsimInf::handleConfSonar (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = sonars->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Sonar");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (sonars, &info, SW_SEN_SONAR_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "MaxRange"))
-	{
+	  break;
+	case KEY_MaxRange:
 	  sw->data.sonar.maxrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MinRange"))
-	{
+	  break;
+	case KEY_MinRange:
 	  sw->data.sonar.minrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "BeamAngle"))
-	{
+	  break;
+	case KEY_BeamAngle:
 	  sw->data.sonar.beamangle = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2437,50 +2632,46 @@ UsarsimInf::handleConfSonar (char *msg)
 int
 UsarsimInf::handleConfRangeimager (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = rangeimagers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "RangeImager");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (rangeimagers, &info, SW_SEN_RANGEIMAGER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "MaxRange"))
-	{
+	  break;
+	case KEY_MaxRange:
 	  sw->data.rangeimager.maxrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MinRange"))
-	{
+	  break;
+	case KEY_MinRange:
 	  sw->data.rangeimager.minrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Resolution"))
-	{
+	  break;
+	case KEY_Resolution:
 	  sw->data.rangeimager.resolutionx = getReal (&info);
 	  sw->data.rangeimager.resolutiony = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Fov"))
-	{
+	  break;
+	case KEY_Fov:
 	  sw->data.rangeimager.fovx = getReal (&info);
 	  sw->data.rangeimager.fovy = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2497,48 +2688,44 @@ UsarsimInf::handleConfRangeimager (char *msg)
 int
 UsarsimInf::handleConfRangescanner (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = rangescanners->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "RangeScanner");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (rangescanners, &info, SW_SEN_RANGESCANNER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "MaxRange"))
-	{
-	  sw->data.rangescanner.maxrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MinRange"))
-	{
+	  break;
+	case KEY_MaxRange:
+	  sw->data.rangescanner.maxrange = getReal (&info);
+	  break;
+	case KEY_MinRange:
 	  sw->data.rangescanner.minrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Resolution"))
-	{
+	  break;
+	case KEY_Resolution:
 	  sw->data.rangescanner.resolution = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Fov"))
-	{
+	  break;
+	case KEY_Fov:
 	  sw->data.rangescanner.fov = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2580,36 +2767,35 @@ UsarsimInf::handleConfCo2sensor (char *msg)
 int
 UsarsimInf::handleConfGroundtruth (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = groundtruths->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GroundTruth");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (groundtruths, &info, SW_SEN_GROUNDTRUTH_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "ScanInterval"))
-	{
+	  break;
+	case KEY_ScanInterval:
 	  sw->data.groundtruth.period = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2625,36 +2811,35 @@ UsarsimInf::handleConfGroundtruth (char *msg)
 int
 UsarsimInf::handleConfGps (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = gpses->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GPS");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (gpses, &info, SW_SEN_GPS_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "ScanInterval"))
-	{
+	  break;
+	case KEY_ScanInterval:
 	  sw->data.gps.period = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2670,11 +2855,11 @@ UsarsimInf::handleConfGps (char *msg)
 int
 UsarsimInf::handleConfIns (char *msg, const char *sensorType)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw;
   UsarsimList *myList;
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   if (!strcmp (sensorType, "INS"))
     myList = inses;
   else if (!strcmp (sensorType, "GroundTruth"))
@@ -2688,29 +2873,28 @@ UsarsimInf::handleConfIns (char *msg, const char *sensorType)
   sw = myList->getSW ();
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, sensorType);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (myList, &info, SW_SEN_INS_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "ScanInterval"))
-	{
+	  break;
+	case KEY_ScanInterval:
 	  sw->data.ins.period = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2726,40 +2910,38 @@ UsarsimInf::handleConfIns (char *msg, const char *sensorType)
 int
 UsarsimInf::handleConfOdometry (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = odometers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Odometry");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (odometers, &info, SW_SEN_ODOMETER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "ScanInterval"))
-	{
+	  break;
+	case KEY_ScanInterval:
 	  sw->data.odometer.period = getReal (&info);
-	}
-      else if (!strcmp (info.token, "EncoderResolution"))
-	{
+	  break;
+	case KEY_EncoderResolution:
 	  sw->data.odometer.resolution = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2775,36 +2957,35 @@ UsarsimInf::handleConfOdometry (char *msg)
 int
 UsarsimInf::handleConfTachometer (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = tachometers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Tachometer");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (tachometers, &info, SW_SEN_TACHOMETER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "ScanInterval"))
-	{
+	  break;
+	case KEY_ScanInterval:
 	  sw->data.odometer.period = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2820,36 +3001,35 @@ UsarsimInf::handleConfTachometer (char *msg)
 int
 UsarsimInf::handleConfAcoustic (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = acoustics->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Acoustic");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (acoustics, &info, SW_SEN_ACOUSTIC_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "ScanInterval"))
-	{
+	  break;
+	case KEY_ScanInterval:
 	  sw->data.odometer.period = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2865,44 +3045,41 @@ UsarsimInf::handleConfAcoustic (char *msg)
 int
 UsarsimInf::handleConfVictim (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = victims->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "VictSensor");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (victims, &info, SW_SEN_VICTIM_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "MaxRange"))
-	{
+	  break;
+	case KEY_MaxRange:
 	  sw->data.victim.maxrange = getReal (&info);
-	}
-      else if (!strcmp (info.token, "HorizontalFOV"))
-	{
+	  break;
+	case KEY_HorizontalFOV:
 	  sw->data.victim.hfov = getReal (&info);
-	}
-      else if (!strcmp (info.token, "VerticalFOV"))
-	{
+	  break;
+	case KEY_VerticalFOV:
 	  sw->data.victim.vfov = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2918,37 +3095,36 @@ UsarsimInf::handleConfVictim (char *msg)
 int
 UsarsimInf::handleConfGripper (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = grippers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Gripper");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (grippers, &info, SW_EFF_GRIPPER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "Opcode"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Opcode:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  //add this to the list of available opcodes for this gripper
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -2961,37 +3137,36 @@ UsarsimInf::handleConfGripper (char *msg)
 int
 UsarsimInf::handleConfToolchanger (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = toolchangers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "ToolChanger");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (toolchangers, &info, SW_EFF_TOOLCHANGER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "Opcode"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Opcode:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  //add this to the list of available opcodes for this gripper
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3007,38 +3182,37 @@ UsarsimInf::handleConfToolchanger (char *msg)
 int
 UsarsimInf::handleConfActuator (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   int i;
   int linkindex;
   sw_struct *sw = misstas->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   linkindex = 0;
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Actuator");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (misstas, &info, SW_ACT_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
 	  sw->data.actuator.number = 0;
-	}
-      else if (!strcmp (info.token, "Link"))
-	{
+	  break;
+	case KEY_Link:
 	  /* expecting number */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (1 != sscanf (info.token, "%i", &i))
+	  if (!info.token.toInteger (&i))
 	    return -1;
 	  if (i < 1)
 	    {
@@ -3057,55 +3231,50 @@ UsarsimInf::handleConfActuator (char *msg)
 	  if (i > sw->data.actuator.number)
 	    sw->data.actuator.number = i;
 	  info.count++;
-	}
-      else if (!strcmp (info.token, "JointType"))
-	{
+	  break;
+	case KEY_JointType:
 	  /* expecting "Revolute" or "Prismatic" */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (!strcmp (info.token, "Prismatic"))
+	  if (info.token.is ("Prismatic"))
 	    {
 	      sw->data.actuator.link[linkindex].type = SW_LINK_PRISMATIC;
 	    }
-	  else if (!strcmp (info.token, "Revolute"))
+	  else if (info.token.is ("Revolute"))
 	    {
 	      sw->data.actuator.link[linkindex].type = SW_LINK_REVOLUTE;
 	    }
-	  else if (!strcmp (info.token, "Scissor"))
+	  else if (info.token.is ("Scissor"))
 	    {
 	      sw->data.actuator.link[linkindex].type = SW_LINK_SCISSOR;
 	    }
 	  else
 	    {
 	      ROS_ERROR ("bad value for %s JointType: %s", sw->name.c_str (),
-			 info.token);
+			 info.token.str ().c_str ());
 	      sw->data.actuator.link[linkindex].type = SW_NONE;
 	    }
 	  info.ptr = info.nextptr;
 	  /* all ok, so credit the count */
 	  info.count++;
-	}
-      else if (!strcmp (info.token, "MaxSpeed"))
-	{
+	  break;
+	case KEY_MaxSpeed:
 	  sw->data.actuator.link[linkindex].maxspeed = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MaxTorque"))
-	{
+	  break;
+	case KEY_MaxTorque:
 	  sw->data.actuator.link[linkindex].maxtorque = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MinValue"))
-	{
+	  break;
+	case KEY_MinValue:
 	  sw->data.actuator.link[linkindex].minvalue = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MaxValue"))
-	{
+	  break;
+	case KEY_MaxValue:
 	  sw->data.actuator.link[linkindex].maxvalue = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3144,79 +3313,74 @@ UsarsimInf::handleConfActuator (char *msg)
 int
 UsarsimInf::handleConfGroundvehicle (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   sw->type = SW_ROBOT_GROUNDVEHICLE;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GroundVehicle");
 	  robot->setDidConf (1);
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Name:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->name = std::string (info.token);
+	  sw->name = info.token.str ();
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "SteeringType"))
-	{
+	  break;
+	case KEY_SteeringType:
 	  /* expecting "SkidSteered", "AckermanSteered" or "OmniDrive" */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (!strcmp (info.token, "SkidSteered"))
+	  if (info.token.is ("SkidSteered"))
 	    {
 	      sw->data.groundvehicle.steertype = SW_STEER_SKID;
 	    }
-	  else if (!strcmp (info.token, "AckermanSteered"))
+	  else if (info.token.is ("AckermanSteered"))
 	    {
 	      sw->data.groundvehicle.steertype = SW_STEER_ACKERMAN;
 	    }
-	  else if (!strcmp (info.token, "OmniDrive"))
+	  else if (info.token.is ("OmniDrive"))
 	    {
 	      sw->data.groundvehicle.steertype = SW_STEER_OMNI;
 	    }
 	  else
 	    {
 	      sw->data.groundvehicle.steertype = SW_STEER_UNKNOWN;
-	      ROS_ERROR ("bad value for SteeringType: %s", info.token);
+	      ROS_ERROR ("bad value for SteeringType: %s", info.token.str ().c_str ());
 	    }
 	  info.ptr = info.nextptr;
 	  info.count++;
-	}
-      else if (!strcmp (info.token, "Mass"))
-	{
+	  break;
+	case KEY_Mass:
 	  sw->data.groundvehicle.mass = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MaxSpeed"))
-	{
+	  break;
+	case KEY_MaxSpeed:
 	  sw->data.groundvehicle.max_speed = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MaxTorque"))
-	{
+	  break;
+	case KEY_MaxTorque:
 	  sw->data.groundvehicle.max_torque = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MaxFrontSteer"))
-	{
+	  break;
+	case KEY_MaxFrontSteer:
 	  sw->data.groundvehicle.max_steer_angle = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip MaxRearSteer, other unknown entries  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3232,37 +3396,37 @@ UsarsimInf::handleConfGroundvehicle (char *msg)
 int
 UsarsimInf::handleConfBasemachine (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   sw->type = SW_ROBOT_FIXED;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "BaseMachine");
 	  robot->setDidConf (1);
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Name:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->name = std::string (info.token);
+	  sw->name = info.token.str ();
 	  info.ptr = info.nextptr;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3278,37 +3442,37 @@ UsarsimInf::handleConfBasemachine (char *msg)
 int
 UsarsimInf::handleConfStaticplatform (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   sw->type = SW_ROBOT_FIXED;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "StaticPlatform");
 	  robot->setDidConf (1);
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Name:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->name = std::string (info.token);
+	  sw->name = info.token.str ();
 	  info.ptr = info.nextptr;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3321,36 +3485,35 @@ UsarsimInf::handleConfStaticplatform (char *msg)
 int
 UsarsimInf::handleConfObjectsensor (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = objectsensors->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "ObjectSensor");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (objectsensors, &info, SW_SEN_OBJECTSENSOR_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
-	}
-      else if (!strcmp (info.token, "Fov"))
-	{
+	  break;
+	case KEY_Fov:
 	  sw->data.objectsensor.fov = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3363,7 +3526,7 @@ UsarsimInf::handleConfObjectsensor (char *msg)
 int
 UsarsimInf::handleConf (char *msg)
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr = msg;
   char *nextptr;
   int count = 0;
@@ -3372,101 +3535,63 @@ UsarsimInf::handleConf (char *msg)
   ROS_DEBUG ("waitingForConf cleared");
   while (1)
     {
-      nextptr = getKey (ptr, token);
+      nextptr = getKey (ptr, &token);
       if (nextptr == ptr)
 	break;
       ptr = nextptr;
 
       /* look for {Type <name>}, and pass the whole msg to the sensor */
-      if (!strcmp (token, "Type"))
+      if (token.is ("Type"))
 	{
-	  nextptr = getValue (ptr, token);
+	  nextptr = getValue (ptr, &token);
 	  if (nextptr == ptr)
 	    return -1;
-	  if (!strcmp (token, "Sonar"))
+	  switch (token.keyword ())
 	    {
+	    case KEY_Sonar:
 	      return handleConfSonar (msg);
-	    }
-	  else if (!strcmp (token, "RangeScanner"))
-	    {
+	    case KEY_RangeScanner:
 	      return handleConfRangescanner (msg);
-	    }
-	  else if (!strcmp (token, "RangeImager"))
-	    {
+	    case KEY_RangeImager:
 	      return handleConfRangeimager (msg);
-	    }
-	  else if (!strcmp (token, "Encoder"))
-	    {
+	    case KEY_Encoder:
 	      return handleConfEncoder (msg);
-	    }
-	  else if (!strcmp (token, "Touch"))
-	    {
+	    case KEY_Touch:
 	      return handleConfTouch (msg);
-	    }
-	  else if (!strcmp (token, "CO2Sensor"))
-	    {
+	    case KEY_CO2Sensor:
 	      return handleConfCo2sensor (msg);
-	    }
-	  else if (!strcmp (token, "GroundTruth"))
-	    {
+	    case KEY_GroundTruth:
 	      return handleConfIns (msg, "GroundTruth");
-	    }
-	  else if (!strcmp (token, "GPS"))
-	    {
+	    case KEY_GPS:
 	      return handleConfGps (msg);
-	    }
-	  else if (!strcmp (token, "INS"))
-	    {
+	    case KEY_INS:
 	      return handleConfIns (msg, "INS");
-	    }
-	  else if (!strcmp (token, "Odometry"))
-	    {
+	    case KEY_Odometry:
 	      return handleConfOdometry (msg);
-	    }
-	  else if (!strcmp (token, "Tachometer"))
-	    {
+	    case KEY_Tachometer:
 	      return handleConfTachometer (msg);
-	    }
-	  else if (!strcmp (token, "Acoustic"))
-	    {
+	    case KEY_Acoustic:
 	      return handleConfAcoustic (msg);
-	    }
-	  else if (!strcmp (token, "VictSensor"))
-	    {
+	    case KEY_VictSensor:
 	      return handleConfVictim (msg);
-	    }
-	  else if (!strcmp (token, "Gripper"))
-	    {
+	    case KEY_Gripper:
 	      return handleConfGripper (msg);
-	    }
-	  else if (!strcmp (token, "ToolChanger"))
-	    {
+	    case KEY_ToolChanger:
 	      return handleConfToolchanger (msg);
-	    }
-	  else if (!strcmp (token, "Actuator"))
-	    {
+	    case KEY_Actuator:
 	      return handleConfActuator (msg);
-	    }
-	  else if (!strcmp (token, "GroundVehicle"))
-	    {
+	    case KEY_GroundVehicle:
 	      return handleConfGroundvehicle (msg);
-	    }
-	  else if (!strcmp (token, "BaseMachine"))
-	    {
+	    case KEY_BaseMachine:
 	      return handleConfBasemachine (msg);
-	    }
-	  else if (!strcmp (token, "StaticPlatform"))
-	    {
+	    case KEY_StaticPlatform:
 	      return handleConfStaticplatform (msg);
-	    }
-	  else if (!strcmp (token, "ObjectSensor"))
-	    {
+	    case KEY_ObjectSensor:
 	      return handleConfObjectsensor (msg);
-	    }
-	  else
-	    {
-	      ROS_ERROR ("Unknown conf type %s", token);
+	    default:
+	      ROS_ERROR ("Unknown conf type %s", token.str ().c_str ());
 	      /* skip it and keep going */
+	      break;
 	    }
 	}
     }
@@ -3480,36 +3605,36 @@ UsarsimInf::handleConf (char *msg)
 int
 UsarsimInf::handleGeoStaticplatform (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   sw->type = SW_ROBOT_FIXED;
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "StaticPlatform");
 	  robot->setDidGeo (1);
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Name:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->name = std::string (info.token);
+	  sw->name = info.token.str ();
 	  info.ptr = info.nextptr;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3525,24 +3650,24 @@ UsarsimInf::handleGeoStaticplatform (char *msg)
 int
 UsarsimInf::handleGeoEncoder (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = encoders->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Encoder");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (encoders, &info, SW_SEN_ENCODER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3552,17 +3677,16 @@ UsarsimInf::handleGeoEncoder (char *msg)
 	  sw->data.encoder.mount.z = getReal (&info);
 	  expect (&info, "Orientation");
 	  sw->data.encoder.mount.roll = getReal (&info);
-	  sw->data.encoder.mount.pitch = getReal (&info);
-	  sw->data.encoder.mount.yaw = getReal (&info);
-	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.encoder.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  sw->data.encoder.mount.pitch = getReal (&info);
+	  sw->data.encoder.mount.yaw = getReal (&info);
+	  expect (&info, "Mount");
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.encoder.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3582,24 +3706,24 @@ UsarsimInf::handleGeoEncoder (char *msg)
 int
 UsarsimInf::handleGeoSonar (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = sonars->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Sonar");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (sonars, &info, SW_SEN_SONAR_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3612,14 +3736,13 @@ UsarsimInf::handleGeoSonar (char *msg)
 	  sw->data.sonar.mount.pitch = getReal (&info);
 	  sw->data.sonar.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.sonar.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.sonar.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3662,24 +3785,24 @@ UsarsimInf::handleGeoCo2sensor (char *msg)
 int
 UsarsimInf::handleGeoGroundtruth (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = groundtruths->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GroundTruth");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (groundtruths, &info, SW_SEN_GROUNDTRUTH_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3692,14 +3815,13 @@ UsarsimInf::handleGeoGroundtruth (char *msg)
 	  sw->data.groundtruth.mount.pitch = getReal (&info);
 	  sw->data.groundtruth.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.groundtruth.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.groundtruth.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  // skip unknown entry 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3715,24 +3837,24 @@ UsarsimInf::handleGeoGroundtruth (char *msg)
 int
 UsarsimInf::handleGeoGps (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = gpses->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GPS");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (gpses, &info, SW_SEN_GPS_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3745,14 +3867,13 @@ UsarsimInf::handleGeoGps (char *msg)
 	  sw->data.gps.mount.pitch = getReal (&info);
 	  sw->data.gps.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.gps.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.gps.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3768,11 +3889,11 @@ UsarsimInf::handleGeoGps (char *msg)
 int
 UsarsimInf::handleGeoIns (char *msg, const char *sensorType)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw;
   UsarsimList *myList;
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   if (!strcmp (sensorType, "INS"))
     myList = inses;
   else if (!strcmp (sensorType, "GroundTruth"))
@@ -3786,17 +3907,17 @@ UsarsimInf::handleGeoIns (char *msg, const char *sensorType)
   sw = myList->getSW ();
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, sensorType);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (myList, &info, SW_SEN_INS_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3809,14 +3930,13 @@ UsarsimInf::handleGeoIns (char *msg, const char *sensorType)
 	  sw->data.ins.mount.pitch = getReal (&info);
 	  sw->data.ins.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.ins.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.ins.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3833,24 +3953,24 @@ UsarsimInf::handleGeoIns (char *msg, const char *sensorType)
 int
 UsarsimInf::handleGeoOdometry (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = odometers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Odometry");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (odometers, &info, SW_SEN_ODOMETER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3863,14 +3983,13 @@ UsarsimInf::handleGeoOdometry (char *msg)
 	  sw->data.odometer.mount.pitch = getReal (&info);
 	  sw->data.odometer.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.odometer.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.odometer.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3886,24 +4005,24 @@ UsarsimInf::handleGeoOdometry (char *msg)
 int
 UsarsimInf::handleGeoTachometer (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = tachometers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Tachometer");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (tachometers, &info, SW_SEN_TACHOMETER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3916,14 +4035,13 @@ UsarsimInf::handleGeoTachometer (char *msg)
 	  sw->data.tachometer.mount.pitch = getReal (&info);
 	  sw->data.tachometer.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.tachometer.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.tachometer.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3939,24 +4057,24 @@ UsarsimInf::handleGeoTachometer (char *msg)
 int
 UsarsimInf::handleGeoAcoustic (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = acoustics->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Acoustic");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (acoustics, &info, SW_SEN_ACOUSTIC_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -3969,14 +4087,13 @@ UsarsimInf::handleGeoAcoustic (char *msg)
 	  sw->data.acoustic.mount.pitch = getReal (&info);
 	  sw->data.acoustic.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.acoustic.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.acoustic.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -3992,24 +4109,24 @@ UsarsimInf::handleGeoAcoustic (char *msg)
 int
 UsarsimInf::handleGeoVictim (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = victims->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "VictSensor");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (victims, &info, SW_SEN_VICTIM_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -4022,22 +4139,20 @@ UsarsimInf::handleGeoVictim (char *msg)
 	  sw->data.victim.mount.pitch = getReal (&info);
 	  sw->data.victim.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.victim.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.victim.mount.offsetFrom, SW_NAME_MAX);
 
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  strncpy (sw->data.victim.parent, info.token,
-		   sizeof (sw->data.victim.parent));
+	  info.token.copy (sw->data.victim.parent, sizeof (sw->data.victim.parent));
 	  NULLTERM (sw->data.victim.parent);
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -4056,22 +4171,22 @@ UsarsimInf::handleGeoComponent (const char *componentName, char *msg,
 				sw_pose & mount, UsarsimList * list,
 				int opcode)
 {
-  componentInfo info;
-  setComponentInfo (msg, &info);
+  UsarsimCursor info;
+  setCursor (msg, &info);
   sw_struct *sw = list->getSW ();
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, componentName);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (list, &info, opcode);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -4085,22 +4200,21 @@ UsarsimInf::handleGeoComponent (const char *componentName, char *msg,
 	  mount.pitch = getReal (&info);
 	  mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (mount.offsetFrom, info.token, SW_NAME_MAX);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (mount.offsetFrom, SW_NAME_MAX);
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "MountLink"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_MountLink:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
 	  mount.linkOffset = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.where->setDidGeo (1);
@@ -4121,28 +4235,28 @@ UsarsimInf::handleGeoComponent (const char *componentName, char *msg,
 int
 UsarsimInf::handleGeoActuator (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   int i;
   int linkindex;
   sw_struct *sw = misstas->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   linkindex = 0;
 
   ROS_INFO( "usarsimInf Actuator geo information: %s", msg );
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Actuator");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (misstas, &info, SW_ACT_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -4158,20 +4272,18 @@ UsarsimInf::handleGeoActuator (char *msg)
 	  sw->data.actuator.mount.pitch = getReal (&info);
 	  sw->data.actuator.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.actuator.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
-	}
-      else if (!strcmp (info.token, "Link"))
-	{
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.actuator.mount.offsetFrom, SW_NAME_MAX);
+	  break;
+	case KEY_Link:
 	  // expecting number 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    {
 	      ROS_ERROR ("Missing link number for mispackage message");
 	      return -1;
 	    }
-	  if (sscanf (info.token, "%i", &i) != 1)
+	  if (!info.token.toInteger (&i))
 	    {
 	      ROS_ERROR ("Missing link number for mispackage message");
 	      return -1;
@@ -4194,17 +4306,16 @@ UsarsimInf::handleGeoActuator (char *msg)
 	    sw->data.actuator.number = i;
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Parent"))
-	{
+	  break;
+	case KEY_Parent:
 	  // expecting number 
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    {
 	      ROS_ERROR ("Missing parent link number for mispackage message");
 	      return -1;
 	    }
-	  if (sscanf (info.token, "%i", &i) != 1)
+	  if (!info.token.toInteger (&i))
 	    {
 	      ROS_ERROR ("Missing parent link number for mispackage message");
 	      return -1;
@@ -4228,29 +4339,25 @@ UsarsimInf::handleGeoActuator (char *msg)
 	  sw->data.actuator.link[linkindex].parent = i;
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Location"))
-	{
+	  break;
+	case KEY_Location:
 	  sw->data.actuator.link[linkindex].mount.x = getReal (&info);
 	  sw->data.actuator.link[linkindex].mount.y = getReal (&info);
 	  sw->data.actuator.link[linkindex].mount.z = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Orientation"))
-	{
+	  break;
+	case KEY_Orientation:
 	  sw->data.actuator.link[linkindex].mount.roll = getReal (&info);
 	  sw->data.actuator.link[linkindex].mount.pitch = getReal (&info);
 	  sw->data.actuator.link[linkindex].mount.yaw = getReal (&info);
-	}
-      else if (!strcmp (info.token, "MountLink"))
-	{
+	  break;
+	case KEY_MountLink:
 	  sw->data.actuator.mount.linkOffset = getReal (&info);
 	  /*
 	  ROS_INFO ("Mountlink for %s is %d", sw->name.c_str (),
 		     sw->data.actuator.mount.linkOffset);
 	  */
-	}
-      else if (!strcmp (info.token, "Tip"))
-	{
+	  break;
+	case KEY_Tip:
 	  sw->data.actuator.tip.x = getReal (&info);
 	  sw->data.actuator.tip.y = getReal (&info);
 	  sw->data.actuator.tip.z = getReal (&info);
@@ -4258,12 +4365,12 @@ UsarsimInf::handleGeoActuator (char *msg)
 		     sw->data.actuator.tip.x,
 		     sw->data.actuator.tip.y,
 		     sw->data.actuator.tip.z);
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry 
 	  ROS_WARN ("Unknown entry in ACTUATOR: %s", info.ptr);
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -4280,24 +4387,24 @@ UsarsimInf::handleGeoActuator (char *msg)
 int
 UsarsimInf::handleGeoGripper (char *msg)
 {
-  componentInfo info;
-  setComponentInfo (msg, &info);
+  UsarsimCursor info;
+  setCursor (msg, &info);
   sw_struct *sw = grippers->getSW ();
 
   ROS_INFO( "usarsimInf Gripper geo information: %s", msg );
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "Gripper");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (grippers, &info, SW_EFF_GRIPPER_SET);
 	  sw = info.where->getSW ();
 	  info.where->setDidConf (1);
@@ -4311,28 +4418,25 @@ UsarsimInf::handleGeoGripper (char *msg)
 	  sw->data.gripper.mount.pitch = getReal (&info);
 	  sw->data.gripper.mount.yaw = getReal (&info);
 	  expect (&info, "Mount");
-	  info.nextptr = getValue (info.ptr, info.token);
-	  ulapi_strncpy (sw->data.gripper.mount.offsetFrom, info.token,
-			 SW_NAME_MAX);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  info.token.copy (sw->data.gripper.mount.offsetFrom, SW_NAME_MAX);
 	  // set up tip references here since not provided by message
 	  ulapi_strncpy (sw->data.gripper.tip.offsetFrom, 
 			 sw->data.gripper.mount.offsetFrom,
 			 SW_NAME_MAX);
 	  info.ptr = info.nextptr;
 	  info.count++;
-	}
-      else if (!strcmp (info.token, "MountLink"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_MountLink:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
 	  sw->data.gripper.mount.linkOffset = getReal (&info);
 	  // set up tip references here since not provided by message
 	  sw->data.gripper.tip.linkOffset = sw->data.gripper.mount.linkOffset;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Tip"))
-	{
+	  break;
+	case KEY_Tip:
 	  //adjust position to be at the tip of the effector instead of the base
 	  sw->data.gripper.tip.x = getReal (&info);
 	  sw->data.gripper.tip.y = getReal (&info);
@@ -4341,11 +4445,11 @@ UsarsimInf::handleGeoGripper (char *msg)
 		     sw->data.gripper.tip.x,
 		     sw->data.gripper.tip.y,
 		     sw->data.gripper.tip.z);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.where->setDidGeo (1);
@@ -4363,65 +4467,60 @@ UsarsimInf::handleGeoGripper (char *msg)
 int
 UsarsimInf::handleGeoGroundvehicle (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   sw->type = SW_ROBOT_GROUNDVEHICLE;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "GroundVehicle");
 	  robot->setDidGeo (1);
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Name:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->name = std::string (info.token);
+	  sw->name = info.token.str ();
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Dimensions"))
-	{
+	  break;
+	case KEY_Dimensions:
 	  sw->data.groundvehicle.length = getReal (&info);
 	  sw->data.groundvehicle.width = getReal (&info);
 	  sw->data.groundvehicle.height = getReal (&info);
-	}
-      else if (!strcmp (info.token, "COG"))
-	{
+	  break;
+	case KEY_COG:
 	  sw->data.groundvehicle.cg.roll = 0;
 	  sw->data.groundvehicle.cg.pitch = 0;
 	  sw->data.groundvehicle.cg.yaw = 0;
 	  sw->data.groundvehicle.cg.x = getReal (&info);
 	  sw->data.groundvehicle.cg.y = getReal (&info);
 	  sw->data.groundvehicle.cg.z = getReal (&info);
-	}
-      else if (!strcmp (info.token, "WheelRadius"))
-	{
+	  break;
+	case KEY_WheelRadius:
 	  sw->data.groundvehicle.wheel_radius = getReal (&info);
-	}
-      else if (!strcmp (info.token, "WheelSeparation"))
-	{
+	  break;
+	case KEY_WheelSeparation:
 	  sw->data.groundvehicle.wheel_separation = getReal (&info);
-	}
-      else if (!strcmp (info.token, "WheelBase"))
-	{
+	  break;
+	case KEY_WheelBase:
 	  sw->data.groundvehicle.wheel_base = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -4437,38 +4536,38 @@ UsarsimInf::handleGeoGroundvehicle (char *msg)
 int
 UsarsimInf::handleGeoBasemachine (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = robot->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   sw->type = SW_ROBOT_FIXED;
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Type"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Type:
 	  expect (&info, "BaseMachine");
 	  robot->setDidGeo (1);
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Name:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  sw->name = std::string (info.token);
+	  sw->name = info.token.str ();
 	  info.ptr = info.nextptr;
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
 
@@ -4481,7 +4580,7 @@ UsarsimInf::handleGeoBasemachine (char *msg)
 int
 UsarsimInf::handleGeo (char *msg)
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr = msg;
   char *nextptr;
   sw_struct *sw;
@@ -4489,117 +4588,83 @@ UsarsimInf::handleGeo (char *msg)
   //  ROS_ERROR ("usarsimInf: geo message: %s", msg );
   while (1)
     {
-      nextptr = getKey (ptr, token);
+      nextptr = getKey (ptr, &token);
       if (nextptr == ptr)
 	break;
       ptr = nextptr;
 
       /* look for {Type <name>}, and pass the whole msg to the sensor */
-      if (!strcmp (token, "Type"))
+      if (token.is ("Type"))
 	{
-	  nextptr = getValue (ptr, token);
+	  nextptr = getValue (ptr, &token);
 	  if (nextptr == ptr)
 	    return -1;
-	  if (!strcmp (token, "Sonar"))
+	  switch (token.keyword ())
 	    {
+	    case KEY_Sonar:
 	      return handleGeoSonar (msg);
-	    }
-	  else if (!strcmp (token, "RangeScanner"))
-	    {
+	    case KEY_RangeScanner:
 	      sw = rangescanners->getSW ();
 	      return handleGeoComponent ("RangeScanner", msg,
 					 sw->data.rangescanner.mount,
 					 rangescanners,
 					 SW_SEN_RANGESCANNER_SET);
-	    }
-	  else if (!strcmp (token, "RangeImager"))
-	    {
+	      break;
+	    case KEY_RangeImager:
 	      sw = rangeimagers->getSW ();
 	      return handleGeoComponent ("RangeImager", msg,
 					 sw->data.rangeimager.mount,
 					 rangeimagers,
 					 SW_SEN_RANGEIMAGER_SET);
-	    }
-	  else if (!strcmp (token, "Encoder"))
-	    {
+	      break;
+	    case KEY_Encoder:
 	      return handleGeoEncoder (msg);
-	    }
-	  else if (!strcmp (token, "Touch"))
-	    {
+	    case KEY_Touch:
 	      return handleGeoTouch (msg);
-	    }
-	  else if (!strcmp (token, "CO2Sensor"))
-	    {
+	    case KEY_CO2Sensor:
 	      return handleGeoCo2sensor (msg);
-	    }
-	  else if (!strcmp (token, "GroundTruth"))
-	    {
+	    case KEY_GroundTruth:
 	      return handleGeoIns (msg, "GroundTruth");
-	    }
-	  else if (!strcmp (token, "GPS"))
-	    {
+	    case KEY_GPS:
 	      return handleGeoGps (msg);
-	    }
-	  else if (!strcmp (token, "INS"))
-	    {
+	    case KEY_INS:
 	      return handleGeoIns (msg, "INS");
-	    }
-	  else if (!strcmp (token, "Odometry"))
-	    {
+	    case KEY_Odometry:
 	      return handleGeoOdometry (msg);
-	    }
-	  else if (!strcmp (token, "Tachometer"))
-	    {
+	    case KEY_Tachometer:
 	      return handleGeoTachometer (msg);
-	    }
-	  else if (!strcmp (token, "Acoustic"))
-	    {
+	    case KEY_Acoustic:
 	      return handleGeoAcoustic (msg);
-	    }
-	  else if (!strcmp (token, "VictSensor"))
-	    {
+	    case KEY_VictSensor:
 	      return handleGeoVictim (msg);
-	    }
-	  else if (!strcmp (token, "Gripper"))
-	    {
+	    case KEY_Gripper:
 	      return handleGeoGripper (msg);
-	    }
-	  else if (!strcmp (token, "ToolChanger"))
-	    {
+	    case KEY_ToolChanger:
 	      sw = toolchangers->getSW ();
 	      return handleGeoComponent ("ToolChanger", msg,
 					 sw->data.toolchanger.mount,
 					 toolchangers,
 					 SW_EFF_TOOLCHANGER_SET);
-	    }
-	  else if (!strcmp (token, "Actuator"))
-	    {
+	      break;
+	    case KEY_Actuator:
 	      return handleGeoActuator (msg);
-	    }
-	  else if (!strcmp (token, "GroundVehicle"))
-	    {
+	    case KEY_GroundVehicle:
 	      return handleGeoGroundvehicle (msg);
-	    }
-	  else if (!strcmp (token, "BaseMachine"))
-	    {
+	    case KEY_BaseMachine:
 	      return handleGeoBasemachine (msg);
-	    }
-	  else if (!strcmp (token, "StaticPlatform"))
-	    {
+	    case KEY_StaticPlatform:
 	      return handleGeoStaticplatform (msg);
-	    }
-	  else if (!strcmp (token, "ObjectSensor"))
-	    {
+	    case KEY_ObjectSensor:
 	      sw = objectsensors->getSW ();
 	      return handleGeoComponent ("ObjectSensor", msg,
 					 sw->data.objectsensor.mount,
 					 objectsensors,
 					 SW_SEN_OBJECTSENSOR_SET);
-	    }
-	  else
-	    {
-	      ROS_ERROR ("Unknown geo type %s", token);
+	      break;
+	    default:
+	      ROS_ERROR ("Unknown geo type %s", token.str ().c_str ());
 	      /* skip it and keep going */
+	      break;
 	    }
 	}
     }
@@ -4616,39 +4681,38 @@ UsarsimInf::handleGeo (char *msg)
 int
 UsarsimInf::handleAsta (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   int i;
   int linkindex = 0;
 
   sw_struct *sw = misstas->getSW ();
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   //  ROS_ERROR( "%s", msg );
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
 
-      if (!strcmp (info.token, "Time"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (misstas, &info, SW_ACT_STAT);
 	  sw = info.where->getSW ();
 	  //      info.where->setDidConf (1);
 	  sw->data.actuator.number = 0;
-	}
-      else if (!strcmp (info.token, "Link"))
-	{
+	  break;
+	case KEY_Link:
 	  /* expecting number */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (sscanf (info.token, "%i", &i) != 1)
+	  if (!info.token.toInteger (&i))
 	    return -1;
 	  if (i < 1)
 	    {
@@ -4668,19 +4732,17 @@ UsarsimInf::handleAsta (char *msg)
 	    sw->data.actuator.number = i;
 	  info.count++;
 	  info.ptr = info.nextptr;
-	}
-      else if (!strcmp (info.token, "Value"))
-	{
+	  break;
+	case KEY_Value:
 	  sw->data.actuator.link[linkindex].position = getReal (&info);
-	}
-      else if (!strcmp (info.token, "Torque"))
-	{
+	  break;
+	case KEY_Torque:
 	  sw->data.actuator.link[linkindex].torque = getReal (&info);
-	}
-      else
-	{
+	  break;
+	default:
 	  /* skip unknown entry  */
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.op = SW_ACT_STAT;
@@ -4691,33 +4753,31 @@ UsarsimInf::handleAsta (char *msg)
 int
 UsarsimInf::handleEff (char *msg)
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr = msg;
   char *nextptr;
   while (1)
     {
-      nextptr = getKey (ptr, token);
+      nextptr = getKey (ptr, &token);
       if (nextptr == ptr)
 	break;
       ptr = nextptr;
       /* look for {Type <name>}, and pass the whole msg to the effector */
-      if (!strcmp (token, "Type"))
+      if (token.is ("Type"))
 	{
-	  nextptr = getValue (ptr, token);
+	  nextptr = getValue (ptr, &token);
 	  if (nextptr == ptr)
 	    return -1;
-	  if (!strcmp (token, "Gripper"))
+	  switch (token.keyword ())
 	    {
+	    case KEY_Gripper:
 	      return handleEffGripper (msg);
-	    }
-	  else if (!strcmp (token, "ToolChanger"))
-	    {
+	    case KEY_ToolChanger:
 	      return handleEffToolchanger (msg);
-	    }
-	  else
-	    {
-	      ROS_ERROR ("Unknown effector type %s", token);
+	    default:
+	      ROS_ERROR ("Unknown effector type %s", token.str ().c_str ());
 	      /* skip it and keep going */
+	      break;
 	    }
 	}
       /* else something else to be handled, probably {Time #} */
@@ -4729,48 +4789,46 @@ UsarsimInf::handleEff (char *msg)
 int
 UsarsimInf::handleEffGripper (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = grippers->getSW ();
 
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
 
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
-      if (!strcmp (info.token, "Time"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Type"))
-	{
+	  break;
+	case KEY_Type:
 	  expect (&info, "Gripper");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (grippers, &info, SW_EFF_GRIPPER_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Status"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Status:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (!ulapi_strcasecmp (info.token, "OPEN"))
+	  if (info.token.isCase ("OPEN"))
 	    sw->data.gripper.status = SW_EFF_OPEN;
-	  else if (!ulapi_strcasecmp (info.token, "CLOSED"))
+	  else if (info.token.isCase ("CLOSED"))
 	    sw->data.gripper.status = SW_EFF_CLOSE;
 	  else
 	    {
-	      ROS_ERROR ("Bad gripper status %s", info.token);
+	      ROS_ERROR ("Bad gripper status %s", info.token.str ().c_str ());
 	    }
-	}
-      else
-	{
+	  break;
+	default:
 	  // skip unknown entry  
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.op = SW_EFF_GRIPPER_STAT;
@@ -4782,65 +4840,63 @@ UsarsimInf::handleEffGripper (char *msg)
 int
 UsarsimInf::handleEffToolchanger (char *msg)
 {
-  componentInfo info;
+  UsarsimCursor info;
   sw_struct *sw = toolchangers->getSW ();
-  setComponentInfo (msg, &info);
+  setCursor (msg, &info);
   while (1)
     {
-      info.nextptr = getKey (info.ptr, info.token);
+      info.nextptr = getKey (info.ptr, &info.token);
       if (info.nextptr == info.ptr)
 	break;
       info.ptr = info.nextptr;
-      if (!strcmp (info.token, "Time"))
+      switch (info.token.keyword ())
 	{
+	case KEY_Time:
 	  getTime (&info);
-	}
-      else if (!strcmp (info.token, "Type"))
-	{
+	  break;
+	case KEY_Type:
 	  expect (&info, "ToolChanger");
-	}
-      else if (!strcmp (info.token, "Name"))
-	{
+	  break;
+	case KEY_Name:
 	  getName (toolchangers, &info, SW_EFF_TOOLCHANGER_STAT);
 	  sw = info.where->getSW ();
-	}
-      else if (!strcmp (info.token, "Status"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Status:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (!ulapi_strcasecmp (info.token, "OPEN"))
+	  if (info.token.isCase ("OPEN"))
 	    sw->data.toolchanger.status = SW_EFF_OPEN;
-	  else if (!ulapi_strcasecmp (info.token, "CLOSED"))
+	  else if (info.token.isCase ("CLOSED"))
 	    sw->data.toolchanger.status = SW_EFF_CLOSE;
 	  else
 	    {
-	      ROS_ERROR ("Bad toolchanger status %s", info.token);
+	      ROS_ERROR ("Bad toolchanger status %s", info.token.str ().c_str ());
 	    }
-	}
-      else if (!strcmp (info.token, "ToolType"))
-	{
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_ToolType:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if (info.nextptr == info.ptr)
 	    return -1;
-	  if (!strcmp (info.token, "Gripper"))
+	  if (info.token.is ("Gripper"))
 	    sw->data.toolchanger.tooltype = SW_EFF_TOOLCHANGER_GRIPPER;
-	  else if (!strcmp (info.token, "Vacuum"))
+	  else if (info.token.is ("Vacuum"))
 	    sw->data.toolchanger.tooltype = SW_EFF_TOOLCHANGER_VACUUM;
-	  else if (!strcmp (info.token, "ToolChanger"))
+	  else if (info.token.is ("ToolChanger"))
 	    sw->data.toolchanger.tooltype = SW_EFF_TOOLCHANGER_TOOLCHANGER;
 	  else
 	    sw->data.toolchanger.tooltype = SW_EFF_TOOLCHANGER_UNKNOWN_TYPE;
-	} else if(!strcmp(info.token, "Tool")) {
-	  info.nextptr = getValue (info.ptr, info.token);
+	  break;
+	case KEY_Tool:
+	  info.nextptr = getValue (info.ptr, &info.token);
 	  if(info.nextptr == info.ptr)
 	    return -1;
-	  strcpy(sw->data.toolchanger.tool_name, info.token);
-	}
-      else
-	{
+	  info.token.copy (sw->data.toolchanger.tool_name, sizeof (sw->data.toolchanger.tool_name));
+	  break;
+	default:
 	  // skip unknown entry  
-	  info.nextptr = getValue (info.ptr, info.token);
+	  info.nextptr = getValue (info.ptr, &info.token);
+	  break;
 	}
     }
   info.op = SW_EFF_TOOLCHANGER_STAT;
@@ -29,35 +29,48 @@
 */
 #ifndef __usarsimInf__
 #define __usarsimInf__
+#include <list>
 #include <ros/ros.h>
+#include <std_msgs/Bool.h>
 #include "simware.hh"
 #include "usarsimMisc.hh"
 #include "genericInf.hh"
 #include "ulapi.hh"
+#include "usarsimStream.hh"
+#include "usarsimQueue.hh"
+#include "usarsimWriter.hh"
+#include "usarsimToken.hh"
 
-#define SOCKET_MUTEX_KEY 1
 #define DELIMITER 10
 #define MAX_MSG_LEN 1024
 #define MAX_TOKEN_LEN 1024
 /* only works with arrays, not heap */
 #define NULLTERM(s) (s)[sizeof(s)-1]=0
-#define BUFFERLEN 8
 
 //////////////////////////////////////////////
 // structures
 //////////////////////////////////////////////
+/* walks one message; token views the most recent key or value */
 typedef struct
 {
-  char token[MAX_TOKEN_LEN];
+  UsarsimToken token;
   char *ptr;
   char *nextptr;
   int sawname;
   int count;
   double time;
   int op;
-  UsarsimList def;
-  UsarsimList *where;
-} componentInfo;
+  UsarsimComponent def;
+  UsarsimComponent *where;
+} UsarsimCursor;
+
+/* a change in whether anyone subscribes to a component's data */
+typedef struct
+{
+  sw_type type;
+  std::string name;
+  int wanted;
+} UsarsimInterest;
 
 //////////////////////////////////////////////
 // class
@@ -67,28 +80,51 @@ class UsarsimInf:public GenericInf
 public:
   UsarsimInf ();
   int init (GenericInf * siblingIn);
-  int tell (sw_struct * sw, componentInfo info);
+  int tell (sw_struct * sw, const UsarsimCursor & info);
   int ask ();
-  char *getKey (char *msg, char *key);
-  char *getValue (char *msg, char *value);
-  int expect (componentInfo * info, const char *token);
-  int getName (UsarsimList * list, componentInfo * info, int op);
-  int getInteger (componentInfo * info);
-  double getReal (componentInfo * info);
-  void getTime (componentInfo * info);
+  char *getKey (char *msg, UsarsimToken * key);
+  char *getValue (char *msg, UsarsimToken * value);
+  int expect (UsarsimCursor * info, const char *token);
+  int getName (UsarsimList * list, UsarsimCursor * info, int op);
+  int getInteger (UsarsimCursor * info);
+  double getReal (UsarsimCursor * info);
+  void getTime (UsarsimCursor * info);
   int msgIn ();
-  int msgout (sw_struct * sw, componentInfo info);
+  int msgout (sw_struct * sw, const UsarsimCursor & info);
   int peerMsg (sw_struct * sw);
+  void setInterest (sw_type type, const std::string & name, int wanted);
+  void setSynchronous ();
+  int publish ();
 
 private:
   int waitingForConf;
   int waitingForGeo;
+  int handshakeStarted;
+  int pipelineHandshake;	// send every request at once
+  double handshakeTimeout;	// resend a request after this many seconds
+  int handshakeCount;
+  int ready;
+  double initTime;
+  double firstMsgTime;
+  ros::Publisher readyPub;
+  /* components still waiting for CONF or GEO, in handshake order */
+  std::list < UsarsimComponent * >pendingConfs;
+  std::list < UsarsimComponent * >pendingGeos;
   int socket_fd;
-  void *socket_mutex;
-  int buildlen;
-  char *build;
-  char *build_ptr;
-  char *build_end;
+  UsarsimWriter writer;
+  void *writerTask;
+  UsarsimStream stream;
+  UsarsimQueue queue;
+  int useQueue;			// publish from our own thread
+  int synchronous;		// publish from the socket thread regardless
+  void *publishTask;
+  /* interest changes from the publishing side, applied by the parser */
+  void *interestMutex;
+  std::list < UsarsimInterest > interests;
+  volatile int interestChanged;
+  /* grippers deleted from the publishing side, also removed by the parser */
+  std::list < std::string > gripperDeletes;
+  volatile int deletesPending;
   char str[MAX_MSG_LEN];
   /* list to hold all of the sensors */
   UsarsimList *encoders;
@@ -111,14 +147,18 @@ private:
   UsarsimList *grippers;
   UsarsimList *toolchangers;
 
-  UsarsimList *robot;
-
-  void setComponentInfo (char *msg, componentInfo * info);
-  ulapi_integer usarsim_socket_write (ulapi_integer id, char *buf,
-				      ulapi_integer len);
-  int doSenConfs (UsarsimList * where, char *type);
-  int doEffConfs (UsarsimList * where, char *type);
-  int doRobotConfs (UsarsimList * where);
+  UsarsimComponent *robot;
+
+  void setCursor (char *msg, UsarsimCursor * info);
+  void queueHandshake (UsarsimComponent * where);
+  void dropHandshake (UsarsimComponent * where);
+  void sendHandshake (std::list < UsarsimComponent * >&pending,
+		      const char *request, int *waiting, int geo);
+  void requestHandshake (const char *request, UsarsimComponent * where);
+  void setReady (int value);
+  void sendPending ();
+  void applyInterest ();
+  void applyDeletes ();
 
   int handleConf (char *msg);
   int handleConfEncoder (char *msg);
@@ -0,0 +1,446 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimKeyword.cpp
+  \brief  Maps protocol words to UsarsimKeyword.
+
+  The lookup switches on the length and then on whichever characters
+  tell the words of that length apart, so any token costs a few jumps
+  and a single memcmp(), however many words are known.
+*/
+#include <string.h>
+#include "usarsimKeyword.hh"
+
+#define MATCH(word) \
+  if (!memcmp (s, #word, len)) return KEY_##word
+
+UsarsimKeyword
+usarsimKeyword (const char *s, size_t len)
+{
+  switch (len)
+    {
+    case 3:
+      switch (s[2])
+	{
+	case 'A':
+	  MATCH (STA);
+	  break;
+	case 'F':
+	  MATCH (EFF);
+	  break;
+	case 'G':
+	  MATCH (COG);
+	  break;
+	case 'N':
+	  MATCH (SEN);
+	  break;
+	case 'O':
+	  switch (s[0])
+	    {
+	    case 'G':
+	      MATCH (GEO);
+	      break;
+	    case 'N':
+	      MATCH (NFO);
+	      break;
+	    }
+	  break;
+	case 'S':
+	  switch (s[0])
+	    {
+	    case 'G':
+	      MATCH (GPS);
+	      break;
+	    case 'I':
+	      MATCH (INS);
+	      break;
+	    case 'R':
+	      MATCH (RES);
+	      break;
+	    }
+	  break;
+	case 'V':
+	  MATCH (FOV);
+	  break;
+	case 'l':
+	  MATCH (Vel);
+	  break;
+	case 'p':
+	  MATCH (Tip);
+	  break;
+	case 's':
+	  switch (s[0])
+	    {
+	    case 'G':
+	      MATCH (Gas);
+	      break;
+	    case 'P':
+	      MATCH (Pos);
+	      break;
+	    }
+	  break;
+	case 'v':
+	  MATCH (Fov);
+	  break;
+	case 'x':
+	  MATCH (Fix);
+	  break;
+	}
+      break;
+    case 4:
+      switch (s[2])
+	{
+	case 'N':
+	  MATCH (CONF);
+	  break;
+	case 'T':
+	  MATCH (ASTA);
+	  break;
+	case 'c':
+	  MATCH (Tick);
+	  break;
+	case 'm':
+	  switch (s[0])
+	    {
+	    case 'N':
+	      MATCH (Name);
+	      break;
+	    case 'T':
+	      MATCH (Time);
+	      break;
+	    }
+	  break;
+	case 'n':
+	  MATCH (Link);
+	  break;
+	case 'o':
+	  MATCH (Tool);
+	  break;
+	case 'p':
+	  MATCH (Type);
+	  break;
+	case 's':
+	  switch (s[0])
+	    {
+	    case 'M':
+	      MATCH (Mass);
+	      break;
+	    case 'P':
+	      MATCH (Pose);
+	      break;
+	    }
+	  break;
+	case 'u':
+	  MATCH (True);
+	  break;
+	}
+      break;
+    case 5:
+      switch (s[3])
+	{
+	case 'a':
+	  MATCH (Sonar);
+	  break;
+	case 'c':
+	  MATCH (Touch);
+	  break;
+	case 'g':
+	  MATCH (Range);
+	  break;
+	case 'm':
+	  MATCH (Frame);
+	  break;
+	case 's':
+	  MATCH (False);
+	  break;
+	case 'u':
+	  MATCH (Value);
+	  break;
+	}
+      break;
+    case 6:
+      switch (s[0])
+	{
+	case 'C':
+	  MATCH (Camera);
+	  break;
+	case 'F':
+	  MATCH (Frames);
+	  break;
+	case 'H':
+	  MATCH (HitLoc);
+	  break;
+	case 'M':
+	  MATCH (MISSTA);
+	  break;
+	case 'O':
+	  switch (s[1])
+	    {
+	    case 'b':
+	      MATCH (Object);
+	      break;
+	    case 'p':
+	      MATCH (Opcode);
+	      break;
+	    }
+	  break;
+	case 'P':
+	  MATCH (Parent);
+	  break;
+	case 'S':
+	  MATCH (Status);
+	  break;
+	case 'T':
+	  MATCH (Torque);
+	  break;
+	case 'V':
+	  switch (s[1])
+	    {
+	    case 'a':
+	      MATCH (Vacuum);
+	      break;
+	    case 'o':
+	      MATCH (Volume);
+	      break;
+	    }
+	  break;
+	}
+      break;
+    case 7:
+      switch (s[0])
+	{
+	case 'D':
+	  MATCH (Density);
+	  break;
+	case 'E':
+	  MATCH (Encoder);
+	  break;
+	case 'G':
+	  MATCH (Gripper);
+	  break;
+	case 'S':
+	  MATCH (Scissor);
+	  break;
+	case 'V':
+	  MATCH (Victims);
+	  break;
+	}
+      break;
+    case 8:
+      switch (s[3])
+	{
+	case 'R':
+	  switch (s[1])
+	    {
+	    case 'a':
+	      MATCH (MaxRange);
+	      break;
+	    case 'i':
+	      MATCH (MinRange);
+	      break;
+	    }
+	  break;
+	case 'S':
+	  MATCH (MaxSpeed);
+	  break;
+	case 'V':
+	  switch (s[1])
+	    {
+	    case 'a':
+	      MATCH (MaxValue);
+	      break;
+	    case 'i':
+	      MATCH (MinValue);
+	      break;
+	    }
+	  break;
+	case 'a':
+	  switch (s[0])
+	    {
+	    case 'D':
+	      MATCH (Duration);
+	      break;
+	    case 'L':
+	      MATCH (Location);
+	      break;
+	    }
+	  break;
+	case 'e':
+	  MATCH (Material);
+	  break;
+	case 'i':
+	  MATCH (Latitude);
+	  break;
+	case 'l':
+	  MATCH (ToolType);
+	  break;
+	case 'm':
+	  MATCH (Odometry);
+	  break;
+	case 'o':
+	  MATCH (Revolute);
+	  break;
+	case 'u':
+	  switch (s[2])
+	    {
+	    case 'o':
+	      MATCH (Acoustic);
+	      break;
+	    case 't':
+	      MATCH (Actuator);
+	      break;
+	    }
+	  break;
+	}
+      break;
+    case 9:
+      switch (s[0])
+	{
+	case 'B':
+	  MATCH (BeamAngle);
+	  break;
+	case 'C':
+	  MATCH (CO2Sensor);
+	  break;
+	case 'D':
+	  MATCH (Direction);
+	  break;
+	case 'J':
+	  MATCH (JointType);
+	  break;
+	case 'L':
+	  MATCH (Longitude);
+	  break;
+	case 'M':
+	  switch (s[1])
+	    {
+	    case 'a':
+	      MATCH (MaxTorque);
+	      break;
+	    case 'o':
+	      MATCH (MountLink);
+	      break;
+	    }
+	  break;
+	case 'N':
+	  MATCH (NoVictims);
+	  break;
+	case 'O':
+	  MATCH (OmniDrive);
+	  break;
+	case 'P':
+	  MATCH (Prismatic);
+	  break;
+	case 'W':
+	  MATCH (WheelBase);
+	  break;
+	}
+      break;
+    case 10:
+      switch (s[0])
+	{
+	case 'D':
+	  MATCH (Dimensions);
+	  break;
+	case 'R':
+	  MATCH (Resolution);
+	  break;
+	case 'S':
+	  MATCH (Satellites);
+	  break;
+	case 'T':
+	  MATCH (Tachometer);
+	  break;
+	case 'V':
+	  MATCH (VictSensor);
+	  break;
+	}
+      break;
+    case 11:
+      switch (s[0])
+	{
+	case 'B':
+	  MATCH (BaseMachine);
+	  break;
+	case 'G':
+	  MATCH (GroundTruth);
+	  break;
+	case 'O':
+	  MATCH (Orientation);
+	  break;
+	case 'R':
+	  MATCH (RangeImager);
+	  break;
+	case 'S':
+	  MATCH (SkidSteered);
+	  break;
+	case 'T':
+	  MATCH (ToolChanger);
+	  break;
+	case 'V':
+	  MATCH (VerticalFOV);
+	  break;
+	case 'W':
+	  MATCH (WheelRadius);
+	  break;
+	}
+      break;
+    case 12:
+      switch (s[1])
+	{
+	case 'a':
+	  MATCH (RangeScanner);
+	  break;
+	case 'b':
+	  MATCH (ObjectSensor);
+	  break;
+	case 'c':
+	  MATCH (ScanInterval);
+	  break;
+	case 't':
+	  MATCH (SteeringType);
+	  break;
+	}
+      break;
+    case 13:
+      switch (s[0])
+	{
+	case 'G':
+	  MATCH (GroundVehicle);
+	  break;
+	case 'H':
+	  MATCH (HorizontalFOV);
+	  break;
+	case 'M':
+	  MATCH (MaxFrontSteer);
+	  break;
+	}
+      break;
+    case 14:
+      MATCH (StaticPlatform);
+      break;
+    case 15:
+      switch (s[0])
+	{
+	case 'A':
+	  MATCH (AckermanSteered);
+	  break;
+	case 'W':
+	  MATCH (WheelSeparation);
+	  break;
+	}
+      break;
+    case 17:
+      MATCH (EncoderResolution);
+      break;
+    }
+  return KEY_UNKNOWN;
+}
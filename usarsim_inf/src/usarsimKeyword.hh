@@ -0,0 +1,135 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimKeyword.hh
+  \brief  Numbers every word of the USARSim protocol the parser acts on.
+
+  Message heads, {Type ...} values and field keys are turned into a
+  UsarsimKeyword once, so that the handlers can route them with a
+  switch instead of a chain of string compares. Each enumerator spells
+  its protocol word exactly, since the protocol uses both "FOV" and
+  "Fov". To support a new word, add it here and to the lookup in
+  usarsimKeyword.cpp.
+*/
+#ifndef __usarsimKeyword__
+#define __usarsimKeyword__
+#include <stddef.h>
+
+typedef enum
+{
+  KEY_UNKNOWN = 0,
+  KEY_AckermanSteered,
+  KEY_Acoustic,
+  KEY_Actuator,
+  KEY_ASTA,
+  KEY_BaseMachine,
+  KEY_BeamAngle,
+  KEY_Camera,
+  KEY_CO2Sensor,
+  KEY_COG,
+  KEY_CONF,
+  KEY_Density,
+  KEY_Dimensions,
+  KEY_Direction,
+  KEY_Duration,
+  KEY_EFF,
+  KEY_Encoder,
+  KEY_EncoderResolution,
+  KEY_False,
+  KEY_Fix,
+  KEY_FOV,
+  KEY_Fov,
+  KEY_Frame,
+  KEY_Frames,
+  KEY_Gas,
+  KEY_GEO,
+  KEY_GPS,
+  KEY_Gripper,
+  KEY_GroundTruth,
+  KEY_GroundVehicle,
+  KEY_HitLoc,
+  KEY_HorizontalFOV,
+  KEY_INS,
+  KEY_JointType,
+  KEY_Latitude,
+  KEY_Link,
+  KEY_Location,
+  KEY_Longitude,
+  KEY_Mass,
+  KEY_Material,
+  KEY_MaxFrontSteer,
+  KEY_MaxRange,
+  KEY_MaxSpeed,
+  KEY_MaxTorque,
+  KEY_MaxValue,
+  KEY_MinRange,
+  KEY_MinValue,
+  KEY_MISSTA,
+  KEY_MountLink,
+  KEY_Name,
+  KEY_NFO,
+  KEY_NoVictims,
+  KEY_Object,
+  KEY_ObjectSensor,
+  KEY_Odometry,
+  KEY_OmniDrive,
+  KEY_Opcode,
+  KEY_Orientation,
+  KEY_Parent,
+  KEY_Pos,
+  KEY_Pose,
+  KEY_Prismatic,
+  KEY_Range,
+  KEY_RangeImager,
+  KEY_RangeScanner,
+  KEY_RES,
+  KEY_Resolution,
+  KEY_Revolute,
+  KEY_Satellites,
+  KEY_ScanInterval,
+  KEY_Scissor,
+  KEY_SEN,
+  KEY_SkidSteered,
+  KEY_Sonar,
+  KEY_STA,
+  KEY_StaticPlatform,
+  KEY_Status,
+  KEY_SteeringType,
+  KEY_Tachometer,
+  KEY_Tick,
+  KEY_Time,
+  KEY_Tip,
+  KEY_Tool,
+  KEY_ToolChanger,
+  KEY_ToolType,
+  KEY_Torque,
+  KEY_Touch,
+  KEY_True,
+  KEY_Type,
+  KEY_Vacuum,
+  KEY_Value,
+  KEY_Vel,
+  KEY_VerticalFOV,
+  KEY_Victims,
+  KEY_VictSensor,
+  KEY_Volume,
+  KEY_WheelBase,
+  KEY_WheelRadius,
+  KEY_WheelSeparation,
+  KEY_COUNT
+} UsarsimKeyword;
+
+/*!
+  \return the keyword spelled by the \a len characters at \a s, or
+  KEY_UNKNOWN.
+*/
+UsarsimKeyword usarsimKeyword (const char *s, size_t len);
+#endif
@@ -0,0 +1,220 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimKinematics.cpp
+  \brief  Turns joint values into link transforms from the robot's URDF.
+*/
+#include <math.h>
+#include <ros/ros.h>
+#include <urdf/model.h>
+#include "usarsimKinematics.hh"
+
+UsarsimKinematics::UsarsimKinematics ()
+{
+}
+
+/*!
+  Read the URDF in \a description and set up the joints, dropping any
+  set up before. Joint values are forgotten.
+  \return the number of moving joints, or -1 if the URDF can't be read.
+*/
+int
+UsarsimKinematics::load (const std::string & description)
+{
+  urdf::Model model;
+  std::map < std::string, boost::shared_ptr < urdf::Joint > >::iterator it;
+  std::map < std::string, int >::iterator found;
+  geometry_msgs::TransformStamped tf;
+  double x, y, z, w;
+  double vx, vy, vz;
+  int n;
+
+  if (!model.initString (description))
+    {
+      ROS_ERROR ("UsarsimKinematics: can't parse the robot description");
+      return -1;
+    }
+  index.clear ();
+  fixed.clear ();
+  moving.clear ();
+  source.clear ();
+  multiplier.clear ();
+  offset.clear ();
+  angular.clear ();
+  linear.clear ();
+  ox.clear ();
+  oy.clear ();
+  oz.clear ();
+  rx.clear ();
+  ry.clear ();
+  rz.clear ();
+  rw.clear ();
+  px.clear ();
+  py.clear ();
+  pz.clear ();
+  pw.clear ();
+  ax.clear ();
+  ay.clear ();
+  az.clear ();
+
+  for (it = model.joints_.begin (); it != model.joints_.end (); it++)
+    {
+      const urdf::Joint & joint = *it->second;
+      const urdf::Pose & origin = joint.parent_to_joint_origin_transform;
+
+      tf.header.frame_id = joint.parent_link_name;
+      tf.child_frame_id = joint.child_link_name;
+      tf.transform.translation.x = origin.position.x;
+      tf.transform.translation.y = origin.position.y;
+      tf.transform.translation.z = origin.position.z;
+      origin.rotation.getQuaternion (x, y, z, w);
+      tf.transform.rotation.x = x;
+      tf.transform.rotation.y = y;
+      tf.transform.rotation.z = z;
+      tf.transform.rotation.w = w;
+      if (joint.type != urdf::Joint::REVOLUTE
+	  && joint.type != urdf::Joint::CONTINUOUS
+	  && joint.type != urdf::Joint::PRISMATIC)
+	{
+	  fixed.push_back (tf);
+	  continue;
+	}
+
+      index[joint.name] = moving.size ();
+      moving.push_back (tf);
+      angular.push_back (joint.type == urdf::Joint::PRISMATIC ? 0 : 1);
+      linear.push_back (joint.type == urdf::Joint::PRISMATIC ? 1 : 0);
+      source.push_back (moving.size () - 1);
+      multiplier.push_back (1);
+      offset.push_back (0);
+      ox.push_back (origin.position.x);
+      oy.push_back (origin.position.y);
+      oz.push_back (origin.position.z);
+      rx.push_back (x);
+      ry.push_back (y);
+      rz.push_back (z);
+      rw.push_back (w);
+      /* the origin rotation times the axis as a pure quaternion */
+      vx = joint.axis.x;
+      vy = joint.axis.y;
+      vz = joint.axis.z;
+      px.push_back (w * vx + y * vz - z * vy);
+      py.push_back (w * vy + z * vx - x * vz);
+      pz.push_back (w * vz + x * vy - y * vx);
+      pw.push_back (-(x * vx + y * vy + z * vz));
+      /* the axis turned into the parent frame, for prismatic joints */
+      ax.push_back (vx + 2 * (w * (y * vz - z * vy)
+			      + y * (x * vy - y * vx) - z * (z * vx - x * vz)));
+      ay.push_back (vy + 2 * (w * (z * vx - x * vz)
+			      + z * (y * vz - z * vy) - x * (x * vy - y * vx)));
+      az.push_back (vz + 2 * (w * (x * vy - y * vx)
+			      + x * (z * vx - x * vz) - y * (y * vz - z * vy)));
+    }
+
+  /* mimic joints take their value from the joint they mimic */
+  for (it = model.joints_.begin (); it != model.joints_.end (); it++)
+    {
+      const urdf::Joint & joint = *it->second;
+
+      if (!joint.mimic || index.find (joint.name) == index.end ())
+	continue;
+      found = index.find (joint.mimic->joint_name);
+      if (found == index.end ())
+	{
+	  ROS_WARN ("UsarsimKinematics: %s mimics unknown joint %s",
+		    joint.name.c_str (), joint.mimic->joint_name.c_str ());
+	  continue;
+	}
+      n = index[joint.name];
+      source[n] = found->second;
+      multiplier[n] = joint.mimic->multiplier;
+      offset[n] = joint.mimic->offset;
+    }
+
+  n = moving.size ();
+  position.assign (n, 0.);
+  known.assign (n, 0);
+  q.resize (n);
+  ROS_INFO ("UsarsimKinematics: %d moving and %d fixed joints", n,
+	    (int) fixed.size ());
+  return n;
+}
+
+/*!
+  \return the entry for moving joint \a name, or -1 if there is none.
+*/
+int
+UsarsimKinematics::jointIndex (const std::string & name) const
+{
+  std::map < std::string, int >::const_iterator found = index.find (name);
+
+  return found == index.end ()? -1 : found->second;
+}
+
+void
+UsarsimKinematics::setPosition (int joint, double value)
+{
+  position[joint] = value;
+  known[joint] = 1;
+}
+
+/*!
+  Work out the transform of every moving joint from the joint values
+  and stamp it with \a stamp.
+  \return the number of moving joints.
+*/
+int
+UsarsimKinematics::update (const ros::Time & stamp)
+{
+  int n = moving.size ();
+  double c, s;
+
+  for (int i = 0; i < n; i++)
+    q[i] = multiplier[i] * position[source[i]] + offset[i];
+  for (int i = 0; i < n; i++)
+    {
+      geometry_msgs::Transform & t = moving[i].transform;
+
+      c = cos (0.5 * angular[i] * q[i]);
+      s = sin (0.5 * angular[i] * q[i]);
+      t.rotation.x = c * rx[i] + s * px[i];
+      t.rotation.y = c * ry[i] + s * py[i];
+      t.rotation.z = c * rz[i] + s * pz[i];
+      t.rotation.w = c * rw[i] + s * pw[i];
+      t.translation.x = ox[i] + linear[i] * q[i] * ax[i];
+      t.translation.y = oy[i] + linear[i] * q[i] * ay[i];
+      t.translation.z = oz[i] + linear[i] * q[i] * az[i];
+      moving[i].header.stamp = stamp;
+    }
+  return n;
+}
+
+int
+UsarsimKinematics::size () const
+{
+  return moving.size ();
+}
+
+/*!
+  \return whether moving joint \a joint, or the joint it mimics, has
+  been given a value.
+*/
+bool
+UsarsimKinematics::isKnown (int joint) const
+{
+  return known[source[joint]] != 0;
+}
+
+const geometry_msgs::TransformStamped &
+UsarsimKinematics::transform (int joint) const
+{
+  return moving[joint];
+}
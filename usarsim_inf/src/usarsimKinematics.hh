@@ -0,0 +1,73 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimKinematics.hh
+  \brief  Turns joint values into link transforms from the robot's URDF.
+
+  UsarsimKinematics does what robot_state_publisher does for the joint
+  states usarsim_node publishes, without another node in between. The
+  URDF is read once. Fixed joints become transforms that never change.
+  Each moving joint becomes one entry in a set of flat arrays holding
+  its origin, the origin's rotation premultiplied into the joint axis
+  and the axis turned into the parent frame. A joint's transform is
+  then
+
+  \code
+  rotation    = cos(q/2) * origin + sin(q/2) * (origin * axis)
+  translation = origin + q * axis in parent
+  \endcode
+
+  with q the joint value times 0 or 1 according to the joint type. This
+  is the same arithmetic for every joint, so each step is a plain loop
+  over the arrays.
+
+  As with robot_state_publisher, a moving joint is left out until it has
+  a value, floating and planar joints are treated as fixed, and a mimic
+  joint follows the joint it mimics. Frames are the URDF link names.
+*/
+#ifndef __usarsimKinematics__
+#define __usarsimKinematics__
+#include <map>
+#include <string>
+#include <vector>
+#include <geometry_msgs/TransformStamped.h>
+
+class UsarsimKinematics
+{
+public:
+  UsarsimKinematics ();
+  int load (const std::string & description);
+  int jointIndex (const std::string & name) const;
+  void setPosition (int joint, double position);
+  int update (const ros::Time & stamp);
+  int size () const;
+  bool isKnown (int joint) const;
+  const geometry_msgs::TransformStamped & transform (int joint) const;
+  std::vector < geometry_msgs::TransformStamped > fixed;	// stamped by the user
+
+private:
+  std::map < std::string, int >index;	// moving joint name to entry
+  std::vector < geometry_msgs::TransformStamped > moving;
+  std::vector < double >position;	// as last set, per joint
+  std::vector < char >known;	// whether it has been set
+  // one entry per moving joint in each of these
+  std::vector < int >source;	// joint whose value drives it
+  std::vector < double >multiplier;	// for mimic joints, else 1 and 0
+  std::vector < double >offset;
+  std::vector < double >angular;	// 1 for revolute, else 0
+  std::vector < double >linear;	// 1 for prismatic, else 0
+  std::vector < double >ox, oy, oz;	// origin translation
+  std::vector < double >rx, ry, rz, rw;	// origin rotation
+  std::vector < double >px, py, pz, pw;	// origin rotation times axis
+  std::vector < double >ax, ay, az;	// axis in the parent frame
+  std::vector < double >q;	// working values
+};
+#endif
@@ -12,6 +12,7 @@
   \file   usarsimMisc.cpp
   \brief  provides misc classes that are needed by usarsim. This includes:
   
+  UsarsimComponent: One named robot component and its sw_struct.
   UsarsimList: Class for maintaining lists of a particular type of sensor.
   UsarsimGrdVeh: Class for reprenting ground vehicle parameters
   UsarsimFlippers: Class for representing flipper parameters
@@ -26,6 +27,11 @@
   \author Stephen Balakirsky
   \date   October 19, 2011
 */
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <sensor_msgs/image_encodings.h>
+#include "ulapi.hh"
 #include "usarsimMisc.hh"
 
 ////////////////////////////////////////////////////////////////////////
@@ -37,80 +43,310 @@ TrajectoryPoint::TrajectoryPoint ()
 
 
 ////////////////////////////////////////////////////////////////////////
-// UsarsimList
+// UsarsimComponent
 ////////////////////////////////////////////////////////////////////////
-UsarsimList::UsarsimList (int typeIn)
+UsarsimComponent::UsarsimComponent (int typeIn)
+{
+  sw.type = typeIn;
+  memset (&sw.data, 0, sizeof (sw.data));
+  handle = -1;
+  hash = 0;
+  live = 0;
+  hsType = NULL;
+  hsRank = 0;
+  reset ();
+}
+
+/* clear the per-name state, keeping any arrays in sw.data */
+void
+UsarsimComponent::reset ()
 {
   sw.time = 0;
   sw.op = SW_NONE;
-  sw.type = typeIn;
   sw.name = "";
   didConfMsg = 0;
   didGeoMsg = 0;
+  queued = 0;
+  confRequestTime = 0;
+  geoRequestTime = 0;
+  wanted = 1;
 }
 
 void
-UsarsimList::setName (const char *name)
+UsarsimComponent::setName (const char *name)
 {
   sw.name = name;
 }
 
-UsarsimList *
-UsarsimList::classFind (std::string name)
+void
+UsarsimComponent::setHandshake (const char *type, int rank)
+{
+  hsType = type;
+  hsRank = rank;
+}
+
+////////////////////////////////////////////////////////////////////////
+// UsarsimList
+////////////////////////////////////////////////////////////////////////
+#define LIST_EMPTY -1
+#define LIST_TOMBSTONE -2
+#define LIST_MIN_TABLE 16
+
+/* FNV-1a */
+static unsigned int
+nameHash (const char *name, size_t len)
+{
+  unsigned int h = 2166136261u;
+
+  for (size_t i = 0; i < len; i++)
+    {
+      h ^= (unsigned char) name[i];
+      h *= 16777619u;
+    }
+  return h;
+}
+
+UsarsimList::UsarsimList (int typeIn):scratch (typeIn)
+{
+  type = typeIn;
+  hsType = NULL;
+  hsRank = 0;
+  table.assign (LIST_MIN_TABLE, LIST_EMPTY);
+  tableUsed = 0;
+  first = -1;
+}
+
+UsarsimList::~UsarsimList ()
+{
+  for (size_t i = 0; i < pool.size (); i++)
+    freeData (&pool[i]);
+  freeData (&scratch);
+}
+
+/*
+  The arrays that used to make every sw_struct as big as the largest
+  sensor are only allocated for the types that use them.
+*/
+void
+UsarsimList::allocData (UsarsimComponent * component)
+{
+  sw_struct *sw = &component->sw;
+
+  switch (type)
+    {
+    case SW_SEN_RANGEIMAGER:
+      if (sw->data.rangeimager.range == NULL)
+	sw->data.rangeimager.range = new float[SW_SEN_RANGEIMAGER_MAX];
+      break;
+    case SW_SEN_RANGESCANNER:
+      if (sw->data.rangescanner.range == NULL)
+	{
+	  sw->data.rangescanner.range = new float[SW_SEN_RANGESCANNER_MAX];
+	  sw->data.rangescanner.capacity = SW_SEN_RANGESCANNER_MAX;
+	}
+      break;
+    case SW_SEN_OBJECTSENSOR:
+      if (sw->data.objectsensor.objects == NULL)
+	{
+	  sw->data.objectsensor.objects =
+	    new sw_sen_object_struct[SW_SEN_OBJECTSENSOR_MAX] ();
+	  sw->data.objectsensor.capacity = SW_SEN_OBJECTSENSOR_MAX;
+	  sw->data.objectsensor.names = new sw_name_pool;
+	}
+      break;
+    case SW_ACT:
+      if (sw->data.actuator.link == NULL)
+	sw->data.actuator.link = new sw_link_struct[SW_ACT_LINK_MAX];
+      break;
+    case SW_OBJECT_CARGO:
+      if (sw->data.cargo.position == NULL)
+	sw->data.cargo.position = new sw_pose[SW_MAX_CARGO];
+      break;
+    }
+}
+
+void
+UsarsimList::freeData (UsarsimComponent * component)
 {
-  UsarsimList *ptr;
+  sw_struct *sw = &component->sw;
 
-  ptr = this;
-  while (ptr->sw.name != "")
+  switch (type)
     {
-      if (ptr->sw.name == name)
+    case SW_SEN_RANGEIMAGER:
+      delete[]sw->data.rangeimager.range;
+      break;
+    case SW_SEN_RANGESCANNER:
+      delete[]sw->data.rangescanner.range;
+      break;
+    case SW_SEN_OBJECTSENSOR:
+      delete[]sw->data.objectsensor.objects;
+      delete sw->data.objectsensor.names;
+      break;
+    case SW_ACT:
+      delete[]sw->data.actuator.link;
+      break;
+    case SW_OBJECT_CARGO:
+      delete[]sw->data.cargo.position;
+      break;
+    }
+}
+
+/*
+  The first component in the list, for handlers that need somewhere to
+  put data before they have seen a name.
+*/
+sw_struct *
+UsarsimList::getSW ()
+{
+  if (first >= 0)
+    return &pool[first].sw;
+  allocData (&scratch);
+  return &scratch.sw;
+}
+
+/* \return the table index holding \a name, or the empty entry ending
+   its probe sequence */
+int
+UsarsimList::lookup (const char *name, size_t len, unsigned int hash)
+{
+  size_t mask = table.size () - 1;
+  size_t i = hash & mask;
+  int slot;
+  UsarsimComponent *c;
+
+  while ((slot = table[i]) != LIST_EMPTY)
+    {
+      if (slot >= 0)
 	{
-	  /* found it */
-	  return ptr;
+	  c = &pool[slot];
+	  if (c->hash == hash && c->sw.name.size () == len
+	      && c->sw.name.compare (0, len, name, len) == 0)
+	    return i;
 	}
-      ptr = ptr->next;
+      i = (i + 1) & mask;
+    }
+  return i;
+}
+
+/* double the table, dropping tombstones */
+void
+UsarsimList::grow ()
+{
+  size_t mask;
+  size_t i;
+
+  table.assign (table.size () * 2, LIST_EMPTY);
+  mask = table.size () - 1;
+  tableUsed = 0;
+  for (size_t slot = 0; slot < pool.size (); slot++)
+    {
+      if (!pool[slot].live)
+	continue;
+      for (i = pool[slot].hash & mask; table[i] != LIST_EMPTY;
+	   i = (i + 1) & mask);
+      table[i] = slot;
+      tableUsed++;
     }
+}
 
-  /* a new one-- fill in the terminal empty structure... */
-  ptr->sw.name = name;
-  ptr->didConfMsg = 0;
-  ptr->didGeoMsg = 0;
+UsarsimComponent *
+UsarsimList::find (const char *name, size_t len)
+{
+  int slot = table[lookup (name, len, nameHash (name, len))];
 
-  /* ...and get a new terminal empty structure */
-  ptr->next = new UsarsimList (ptr->sw.type);
-  return ptr;
+  return slot >= 0 ? &pool[slot] : NULL;
 }
+
+UsarsimComponent *
+UsarsimList::getComponent (int handle)
+{
+  if (handle < 0 || handle >= (int) pool.size () || !pool[handle].live)
+    return NULL;
+  return &pool[handle];
+}
+
+UsarsimComponent *
+UsarsimList::classFind (std::string name)
+{
+  return classFind (name.data (), name.size ());
+}
+
 /*
-  Remove a usarsim robot component from the list.
-  Return the new front element of the list.
+  Find the component called \a name, adding it if this is the first
+  time the name has been seen. The name is a (pointer, length) pair so
+  that a token can be looked up without building a string for it.
 */
-UsarsimList*
-UsarsimList::remove(std::string name)
-{
-  if(name != "")
-  {
-    UsarsimList *ptr;
-    UsarsimList *next;
-    ptr = this;
-    next = ptr->next;
-    if(this->sw.name == name)
+UsarsimComponent *
+UsarsimList::classFind (const char *name, size_t len)
+{
+  unsigned int hash = nameHash (name, len);
+  int index = lookup (name, len, hash);
+  int slot;
+  UsarsimComponent *c;
+
+  if (table[index] >= 0)
+    return &pool[table[index]];
+
+  /* a new one-- reuse a free slot or add one to the pool */
+  if (!freeSlots.empty ())
     {
-      delete this;
-      return next;
+      slot = freeSlots.back ();
+      freeSlots.pop_back ();
     }
-    while(next->sw.name != "")
+  else
+    {
+      slot = pool.size ();
+      pool.push_back (UsarsimComponent (type));
+    }
+  c = &pool[slot];
+  c->reset ();
+  c->sw.name.assign (name, len);
+  c->handle = slot;
+  c->hash = hash;
+  c->live = 1;
+  c->setHandshake (hsType, hsRank);
+  allocData (c);
+  if (first < 0 || slot < first)
+    first = slot;
+
+  table[index] = slot;
+  tableUsed++;
+  if (2 * tableUsed >= table.size ())
+    grow ();
+  return c;
+}
+
+/*
+  Remove a usarsim robot component from the list. Its slot and arrays
+  are kept for the next new component.
+*/
+void
+UsarsimList::remove (std::string name)
+{
+  int index = lookup (name.data (), name.size (),
+		      nameHash (name.data (), name.size ()));
+  int slot = table[index];
+
+  if (slot < 0)
+    return;
+  table[index] = LIST_TOMBSTONE;
+  pool[slot].live = 0;
+  pool[slot].reset ();
+  freeSlots.push_back (slot);
+  if (slot == first)
     {
-      if(next->sw.name == name)
-      {
-        ptr->next = next->next;
-        delete next;
-        return this;
-      }
-      ptr = next;
-      next = next->next;
+      for (first++; first < (int) pool.size () && !pool[first].live;
+	   first++);
+      if (first == (int) pool.size ())
+	first = -1;
     }
-  }
-  return this;
+}
+
+void
+UsarsimList::setHandshake (const char *type, int rank)
+{
+  hsType = type;
+  hsRank = rank;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -167,11 +403,51 @@ UsarsimFlippers::UsarsimFlippers ()
 ////////////////////////////////////////////////////////////////////////
 // UsarsimSensor
 ////////////////////////////////////////////////////////////////////////
+UsarsimThrottle::UsarsimThrottle ()
+{
+  period = 0;
+  decimation = 1;
+  count = 0;
+  next = 0;
+}
+
+/*!
+  Let at most \a maxRate messages a second through, 0 meaning no limit,
+  and only consider every \a decimation'th message.
+*/
+void
+UsarsimThrottle::set (double maxRate, int decimationIn)
+{
+  period = maxRate > 0 ? 1. / maxRate : 0;
+  decimation = decimationIn > 1 ? decimationIn : 1;
+  count = 0;
+  next = 0;
+}
+
+/*!
+  \return whether the message arriving at time \a now should be used.
+*/
+bool
+UsarsimThrottle::pass (double now)
+{
+  if (++count < decimation)
+    return false;
+  count = 0;
+  if (period <= 0)
+    return true;
+  if (now < next)
+    return false;
+  /* keep to the schedule unless we've fallen a whole period behind */
+  next = now - next < period ? next + period : now + period;
+  return true;
+}
+
 UsarsimSensor::UsarsimSensor ()
 {
   time = 0;
   
   transformSet = false;
+  wanted = true;
   tf::Transform transform;
   transform.setIdentity();
   tf::transformTFToMsg(transform, tf.transform);
@@ -195,6 +471,7 @@ UsarsimOdomSensor::UsarsimOdomSensor ():UsarsimSensor ()
 ////////////////////////////////////////////////////////////////////////
 UsarsimRngScnSensor::UsarsimRngScnSensor ():UsarsimSensor ()
 {
+  fov = resolution = -1;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -243,6 +520,110 @@ UsarsimGripperEffector::isDone ()
   return false;
 }
 
+////////////////////////////////////////////////////////////////////////
+// Depth frame assembler
+////////////////////////////////////////////////////////////////////////
+#define BITS_PER_WORD (8 * sizeof (unsigned long))
+
+UsarsimDepthAssembler::UsarsimDepthAssembler ()
+{
+  filling = 0;
+  arrived = 0;
+  totalFrames = 0;
+}
+
+/* size both buffers for a new resolution; only done when it changes */
+void
+UsarsimDepthAssembler::resize (int width, int height, int frames)
+{
+  for (int i = 0; i < 2; i++)
+    {
+      images[i].width = width;
+      images[i].height = height;
+      images[i].step = width * sizeof (float);
+      images[i].encoding = sensor_msgs::image_encodings::TYPE_32FC1;
+      images[i].data.assign (images[i].step * height, 0);
+    }
+  totalFrames = frames;
+  frameBits.assign ((frames + BITS_PER_WORD - 1) / BITS_PER_WORD, 0);
+  arrived = 0;
+}
+
+void
+UsarsimDepthAssembler::startScan ()
+{
+  std::fill (frameBits.begin (), frameBits.end (), 0);
+  arrived = 0;
+}
+
+/*!
+  Copy one frame into the image being assembled.
+  \return true if it completed a scan, which is then available from
+  completed().
+*/
+bool
+UsarsimDepthAssembler::addFrame (const sw_sen_rangeimager_struct & frame)
+{
+  sensor_msgs::Image & image = images[filling];
+  size_t pixels;
+  size_t offset;
+  size_t count;
+  unsigned long bit;
+  unsigned long *word;
+
+  if (frame.totalframes <= 0 || frame.frame < 0
+      || frame.frame >= frame.totalframes)
+    return false;
+  if ((int) image.width != frame.resolutionx
+      || (int) image.height != frame.resolutiony
+      || totalFrames != frame.totalframes)
+    resize (frame.resolutionx, frame.resolutiony, frame.totalframes);
+
+  word = &frameBits[frame.frame / BITS_PER_WORD];
+  bit = 1UL << (frame.frame % BITS_PER_WORD);
+  if (*word & bit)
+    {
+      /* a frame we already have means the last scan was cut short */
+      ROS_DEBUG ("range imager scan restarted after %d of %d frames",
+		 arrived, totalFrames);
+      startScan ();
+    }
+
+  /*
+     Frames break on row boundaries and all but the last hold the same
+     number of values, so the last frame is placed against the end of
+     the image.
+   */
+  pixels = (size_t) image.width * image.height;
+  count = frame.numberperframe > 0 ? frame.numberperframe : 0;
+  if (count > pixels)
+    count = pixels;
+  if (frame.frame == frame.totalframes - 1)
+    offset = pixels - count;
+  else
+    offset = (size_t) frame.frame * count;
+  if (offset >= pixels)
+    {
+      /* frames that don't fit the image, from a stale or wrong CONF */
+      ROS_WARN ("range imager frame %d of %d with %d values is past "
+		"the end of a %ux%u image", frame.frame, frame.totalframes,
+		frame.numberperframe, image.width, image.height);
+      return false;
+    }
+  if (offset + count > pixels)
+    count = pixels - offset;
+  memcpy (&image.data[offset * sizeof (float)], frame.range,
+	  count * sizeof (float));
+
+  *word |= bit;
+  if (++arrived < totalFrames)
+    return false;
+  /* hand the finished image out and fill the other one next */
+  filling = 1 - filling;
+  startScan ();
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////
 // Range imager
 ////////////////////////////////////////////////////////////////////////
@@ -251,42 +632,135 @@ UsarsimRngImgSensor::UsarsimRngImgSensor (GenericInf * parentInf):UsarsimSensor
 {
   infHandle = parentInf;
   ready = true;
+  imageReady = false;
+  scanWanted = true;
+  scanRequested = 0;
+  scanMutex = NULL;
+  continuous = false;
   lastFrameReceived = 0;
+  infoFovx = infoFovy = -1;
+  //simulated range images have no distortion and need no rectifying
+  camInfo.distortion_model = "plumb_bob";
+  camInfo.D.assign (5, 0.);
+  camInfo.R[0] = camInfo.R[4] = camInfo.R[8] = 1;
 }
 
+/*!
+  Fill in the camera info for a \a width x \a height image with fields
+  of view \a fovx and \a fovy in radians, using the same centered
+  pinhole model as the point clouds. A \a fovy of 0 means square
+  pixels. Nothing is recomputed unless one of them changed.
+*/
+void
+UsarsimRngImgSensor::setIntrinsics (int width, int height, double fovx,
+				    double fovy)
+{
+  double fx, fy, cx, cy;
+
+  if (width == (int) camInfo.width && height == (int) camInfo.height
+      && fovx == infoFovx && fovy == infoFovy)
+    return;
+  camInfo.width = width;
+  camInfo.height = height;
+  infoFovx = fovx;
+  infoFovy = fovy;
+  fx = fovx > 0 ? (width / 2.) / tan (fovx / 2.) : 0;
+  fy = fovy > 0 ? (height / 2.) / tan (fovy / 2.) : fx;
+  cx = (width - 1) / 2.;
+  cy = (height - 1) / 2.;
+  std::fill (camInfo.K.begin (), camInfo.K.end (), 0.);
+  camInfo.K[0] = fx;
+  camInfo.K[2] = cx;
+  camInfo.K[4] = fy;
+  camInfo.K[5] = cy;
+  camInfo.K[8] = 1;
+  std::fill (camInfo.P.begin (), camInfo.P.end (), 0.);
+  camInfo.P[0] = fx;
+  camInfo.P[2] = cx;
+  camInfo.P[5] = fy;
+  camInfo.P[6] = cy;
+  camInfo.P[10] = 1;
+  ROS_DEBUG ("%s intrinsics: %dx%d fx %f fy %f", name.c_str (), width,
+	     height, fx, fy);
+}
+
+/*!
+  \return whether the last frame of the scan has arrived, so that
+  another scan may be asked for.
+*/
 bool
 UsarsimRngImgSensor::isReady ()
 {
   return ready;
 }
 
+/*!
+  \return whether the frame just received completed an image to publish.
+*/
+bool
+UsarsimRngImgSensor::hasImage ()
+{
+  return imageReady;
+}
+
 void
-UsarsimRngImgSensor::sentFrame (int frame)
+UsarsimRngImgSensor::sentFrame (const sw_sen_rangeimager_struct & frame)
 {
-  ROS_INFO ("receiving frame %d of %d", frame, totalFrames);
-  lastFrameReceived = frame;
-  if (lastFrameReceived == totalFrames - 1)
+  ROS_DEBUG ("receiving frame %d of %d", frame.frame, totalFrames);
+  lastFrameReceived = frame.frame;
+  //the scan is over at its last frame, whether or not the image is whole
+  ready = lastFrameReceived == totalFrames - 1;
+  imageReady = false;
+  if (frame.numberperframe <= 0)
+    return;			/* skipped by the parser, nobody is listening */
+  if (!scanWanted)
+    return;			/* thinned out by the throttle, not published */
+  if (depth.addFrame (frame))
     {
-      ready = true;
-      ROS_INFO ("RangeImager scan complete.");
+      imageReady = true;
+      ROS_DEBUG ("RangeImager scan complete.");
     }
-  else
-    ready = false;
 }
 
 void
 UsarsimRngImgSensor::commandCallback (const usarsim_inf::
 				      RangeImageScanConstPtr & msg)
 {
-  if (ready)
+  //an extra SCAN would upset the continuous scan schedule
+  if (continuous)
     {
-      sw_struct newSw;
-      newSw.type = SW_SEN_RANGEIMAGER;
-      newSw.op = SW_ROS_CMD_SCAN;
-      newSw.name = name;
-      newSw.data.roscmdscan.dummy = 1;
-      infHandle->sibling->peerMsg (&newSw);
+      ROS_DEBUG ("%s scans continuously, ignoring scan command",
+		 name.c_str ());
+      return;
     }
+  if (ready)
+    requestScan ();
+}
+
+/*!
+  Ask USARSim for a new scan.
+*/
+void
+UsarsimRngImgSensor::requestScan ()
+{
+  sw_struct newSw;
+
+  if (scanMutex != NULL)
+    ulapi_mutex_take (scanMutex);
+  scanRequested = ros::Time::now ().toSec ();
+  if (scanMutex != NULL)
+    ulapi_mutex_give (scanMutex);
+  newSw.type = SW_SEN_RANGEIMAGER;
+  newSw.op = SW_ROS_CMD_SCAN;
+  newSw.name = name;
+  newSw.data.roscmdscan.dummy = 1;
+  infHandle->sibling->peerMsg (&newSw);
+}
+
+void
+UsarsimRngImgSensor::scanTimerCallback (const ros::TimerEvent & event)
+{
+  requestScan ();
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -347,6 +821,8 @@ geometry_msgs::Point
 UsarsimActuator::UsarsimActuator (GenericInf * parentInf):UsarsimSensor ()
 {
   infHandle = parentInf;
+  numJoints = 0;
+  chainChanged = false;
 
   trajectoryServer = NULL;
   // initialize cycle timer to contain 5 values
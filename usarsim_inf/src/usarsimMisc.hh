@@ -30,6 +30,7 @@
 #ifndef __usarsimMisc__
 #define __usarsimMisc__
 #include <deque>
+#include <vector>
 #include <ros/ros.h>
 #include <tf/transform_broadcaster.h>
 #include <nav_msgs/Odometry.h>
@@ -46,6 +47,8 @@
 #include <usarsim_inf/RangeImageScan.h>
 #include "simware.hh"
 #include "genericInf.hh"
+#include "usarsimCloud.hh"
+#include "usarsimDepthCodec.hh"
 
 //using namespace std;
 
@@ -83,19 +86,22 @@ typedef struct CycleTimer
 }CycleTimer;
 
 ////////////////////////////////////////////////////////////////////////
-// UsarsimList
+// UsarsimComponent
 ////////////////////////////////////////////////////////////////////////
-class UsarsimList
+class UsarsimComponent
 {
 public:
-  UsarsimList (int typeIn = SW_TYPE_UNINITIALIZED);
+  UsarsimComponent (int typeIn = SW_TYPE_UNINITIALIZED);
   void setName (const char *name);
   sw_struct *getSW ()
   {
     return &sw;
   }
-  UsarsimList *classFind (std::string name);
-  UsarsimList *remove (std::string name);
+  /* small integer naming this component within its UsarsimList */
+  int getHandle ()
+  {
+    return handle;
+  }
   int didConf ()
   {
     return didConfMsg;
@@ -112,18 +118,107 @@ public:
   {
     didGeoMsg = value;
   }
-  UsarsimList *getNext ()
+  /* USARSim type used in GETCONF/GETGEO, and the order lists are done in */
+  void setHandshake (const char *type, int rank);
+  const char *handshakeType ()
+  {
+    return hsType;
+  }
+  int handshakeRank ()
   {
-    return next;
+    return hsRank;
+  }
+  int isQueued ()
+  {
+    return queued;
+  }
+  void setQueued (int value)
+  {
+    queued = value;
+  }
+  /* when GETCONF/GETGEO were last sent for this component, 0 if never */
+  double confRequested ()
+  {
+    return confRequestTime;
+  }
+  double geoRequested ()
+  {
+    return geoRequestTime;
+  }
+  void setConfRequested (double t)
+  {
+    confRequestTime = t;
+  }
+  void setGeoRequested (double t)
+  {
+    geoRequestTime = t;
+  }
+  /* whether anyone wants this component's bulk data parsed */
+  int isWanted ()
+  {
+    return wanted;
+  }
+  void setWanted (int value)
+  {
+    wanted = value;
   }
 
 private:
+  friend class UsarsimList;
   sw_struct sw;
+  int handle;
+  unsigned int hash;
+  int live;
   int didConfMsg;
   int didGeoMsg;
-  UsarsimList *next;
+  const char *hsType;
+  int hsRank;
+  int queued;
+  double confRequestTime;
+  double geoRequestTime;
+  int wanted;
+  void reset ();
 };
 
+////////////////////////////////////////////////////////////////////////
+// UsarsimList
+////////////////////////////////////////////////////////////////////////
+/*
+  All of the components of one type, looked up by name. Names are
+  interned into an open addressing hash table that maps them to a slot
+  in a pool of components; the slot index is the component's handle.
+  The pool never moves its components, and a removed component's slot,
+  along with the type specific arrays allocated for it, is reused by
+  the next new name.
+*/
+class UsarsimList
+{
+public:
+  UsarsimList (int typeIn = SW_TYPE_UNINITIALIZED);
+  ~UsarsimList ();
+  sw_struct *getSW ();
+  UsarsimComponent *classFind (std::string name);
+  UsarsimComponent *classFind (const char *name, size_t len);
+  UsarsimComponent *find (const char *name, size_t len);
+  UsarsimComponent *getComponent (int handle);
+  void remove (std::string name);
+  void setHandshake (const char *type, int rank);
+
+private:
+  int type;
+  const char *hsType;
+  int hsRank;
+  std::deque < UsarsimComponent > pool;
+  std::vector < int >freeSlots;
+  std::vector < int >table;	// slot index, or one of the marks below
+  size_t tableUsed;		// slots plus tombstones in the table
+  int first;			// lowest live slot, -1 if none
+  UsarsimComponent scratch;	// stands in for getSW() while empty
+  int lookup (const char *name, size_t len, unsigned int hash);
+  void grow ();
+  void allocData (UsarsimComponent * component);
+  void freeData (UsarsimComponent * component);
+};
 
 ////////////////////////////////////////////////////////////////////////
 // Flippers
@@ -206,6 +301,27 @@ public:
   int numFlippers;
 };
 
+////////////////////////////////////////////////////////////////////////
+// UsarsimThrottle
+////////////////////////////////////////////////////////////////////////
+/*
+  Thins out a sensor's messages: only every decimation'th message is
+  considered, and of those no more than maxRate per second pass. Both
+  default to letting everything through.
+*/
+class UsarsimThrottle
+{
+public:
+  UsarsimThrottle ();
+  void set (double maxRate, int decimation);
+  bool pass (double now);
+private:
+  double period;		// seconds between messages, 0 for no limit
+  int decimation;
+  int count;			// messages since the last one considered
+  double next;			// earliest time the next one may pass
+};
+
 ////////////////////////////////////////////////////////////////////////
 // UsarsimSensor
 ////////////////////////////////////////////////////////////////////////
@@ -219,6 +335,8 @@ public:
   geometry_msgs::TransformStamped tf;	// transform for sensor
   int linkOffset; //which link this component is mounted on. -1 if not parented to a link.
   bool transformSet;
+  bool wanted; //whether the parser was last told someone subscribes
+  UsarsimThrottle throttle; //limits how often the data is published
 };
 
 ////////////////////////////////////////////////////////////////////////
@@ -241,7 +359,40 @@ class UsarsimRngScnSensor:public UsarsimSensor
 public:
   UsarsimRngScnSensor ();
   sensor_msgs::LaserScan scan;
+  double fov; //settings the scan's angles were worked out for
+  double resolution;
 };
+////////////////////////////////////////////////////////////////////////
+// Depth frame assembler
+////////////////////////////////////////////////////////////////////////
+/*
+  Builds depth images from the partial frames a range imager sends.
+  The image is sized once from the resolution, each frame is copied in
+  place at its offset and a bitmap records which frames have arrived.
+  When the last missing frame comes in the image is complete, and the
+  next scan is assembled in the other buffer so the finished one can be
+  published while it fills.
+*/
+class UsarsimDepthAssembler
+{
+public:
+  UsarsimDepthAssembler ();
+  bool addFrame (const sw_sen_rangeimager_struct & frame);
+  /* the most recently completed scan */
+  sensor_msgs::Image & completed ()
+  {
+    return images[1 - filling];
+  }
+private:
+  sensor_msgs::Image images[2];
+  int filling;			// index of the image being assembled
+  std::vector < unsigned long > frameBits;
+  int arrived;			// frames of this scan seen so far
+  int totalFrames;
+  void resize (int width, int height, int frames);
+  void startScan ();
+};
+
 ////////////////////////////////////////////////////////////////////////
 // Range Imager
 ////////////////////////////////////////////////////////////////////////
@@ -250,18 +401,41 @@ class UsarsimRngImgSensor:public UsarsimSensor
 public:
   UsarsimRngImgSensor(GenericInf *parentInf);
   GenericInf *infHandle;
-  sensor_msgs::Image depthImage;
+  UsarsimDepthAssembler depth;
+  UsarsimDepthCloud cloudMaker;
+  sensor_msgs::PointCloud2 cloud;
+  ros::Publisher cloudPub;
+  UsarsimVoxelGrid voxels;
+  sensor_msgs::PointCloud2 coarseCloud; //voxel downsampled cloud
+  ros::Publisher coarseCloudPub;
+  UsarsimDepthEncoder depthCodec;
+  sensor_msgs::Image depth16; //millimetre copy of the depth image
+  sensor_msgs::CompressedImage compressedDepth;
+  ros::Publisher compressedPub;
   int totalFrames;
   ros::Publisher cameraInfoPub;
   ros::Subscriber command;
   sensor_msgs::CameraInfo camInfo;
+  std::string opticalFrame; //frame id for the depth image
   geometry_msgs::TransformStamped opticalTransform;
+  void setIntrinsics(int width, int height, double fovx, double fovy);
   bool isReady();
-  void sentFrame(int frame);
+  bool hasImage();
+  bool scanWanted; //false while the throttle skips the current scan
+  void sentFrame(const sw_sen_rangeimager_struct &frame);
   void commandCallback(const usarsim_inf::RangeImageScanConstPtr &msg);
+  double scanRequested; //ROS time the last SCAN was sent, 0 if never
+  void *scanMutex; //guards scanRequested, owned by the interface
+  ros::Timer scanTimer; //sends a delayed SCAN in continuous mode
+  bool continuous; //scans are scheduled by the interface, not on command
+  void requestScan();
+  void scanTimerCallback(const ros::TimerEvent &event);
 private:
   int lastFrameReceived;
-  bool ready;
+  bool ready; //the last frame of the scan arrived
+  bool imageReady; //the last frame completed the depth image
+  double infoFovx; //fields of view camInfo was worked out for
+  double infoFovy;
 };
 ////////////////////////////////////////////////////////////////////////
 // Object sensor
@@ -319,8 +493,13 @@ public:
   std::vector<float> maxValues; 
   std::vector<float> maxTorques; //config data needed for URDF generation
   std::vector<link_type> jointTypes; //prismatic or revolute (ignore fixed joints)
-  std::vector <geometry_msgs::TransformStamped> jointTf; // transforms for links
+  std::vector<int> linkParents; //index of each link's parent, 0 for the base
+  std::vector <geometry_msgs::TransformStamped> jointTf; // transforms for links, then the tip
   std::vector <tf::Vector3> jointAxes; //joint axes
+  std::vector<std::string> jointNames; //worked out once with the chain
+  std::vector<int> jointIndices; //where each joint is in the joint state
+  std::vector<std::string> linkFrames; //base frame, then one per link
+  bool chainChanged; //chain recompiled since its transforms were published
   
   sensor_msgs::JointState jstate;
   GenericInf *infHandle;
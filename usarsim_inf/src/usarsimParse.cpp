@@ -0,0 +1,239 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimParse.cpp
+  \brief  Number parsing for the USARSim text protocol.
+*/
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include "usarsimParse.hh"
+
+/* powers of ten that are exact in a double */
+static const double exactPow10[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+  1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20,
+  1e21, 1e22
+};
+
+#define MAX_EXACT_POW10 22
+#define MAX_EXACT_MANTISSA (1ULL << 53)
+#define MAX_MANTISSA_DIGITS 19
+
+static inline int
+isDigit (char c)
+{
+  return (unsigned char) (c - '0') < 10;
+}
+
+static inline int
+isBlank (char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+const char *
+usarsimParseReal (const char *s, double *d)
+{
+  const char *p = s;
+  const char *digits;
+  unsigned long long mantissa = 0;
+  int ndigits = 0;
+  int exponent = 0;
+  int negative = 0;
+  double value;
+  char *end;
+
+  if (*p == '-')
+    {
+      negative = 1;
+      p++;
+    }
+  else if (*p == '+')
+    p++;
+
+  digits = p;
+  for (; isDigit (*p); p++)
+    {
+      if (ndigits < MAX_MANTISSA_DIGITS)
+	{
+	  mantissa = mantissa * 10 + (*p - '0');
+	  if (mantissa != 0)
+	    ndigits++;
+	}
+      else
+	exponent++;
+    }
+  if (*p == '.')
+    {
+      p++;
+      for (; isDigit (*p); p++)
+	{
+	  if (ndigits < MAX_MANTISSA_DIGITS)
+	    {
+	      mantissa = mantissa * 10 + (*p - '0');
+	      if (mantissa != 0)
+		ndigits++;
+	      exponent--;
+	    }
+	}
+    }
+  if (p == digits || (p == digits + 1 && *digits == '.'))
+    {
+      /* no digits -- maybe inf or nan, let strtod decide */
+      value = strtod (s, &end);
+      if (end == s)
+	return s;
+      *d = value;
+      return end;
+    }
+  if (*p == 'e' || *p == 'E')
+    {
+      const char *e = p + 1;
+      int expNegative = 0;
+      int expValue = 0;
+
+      if (*e == '-')
+	{
+	  expNegative = 1;
+	  e++;
+	}
+      else if (*e == '+')
+	e++;
+      if (isDigit (*e))
+	{
+	  for (; isDigit (*e); e++)
+	    if (expValue < 10000)
+	      expValue = expValue * 10 + (*e - '0');
+	  exponent += expNegative ? -expValue : expValue;
+	  p = e;
+	}
+    }
+
+  /*
+     The fast path is exact when the mantissa and the power of ten are
+     both representable, since one IEEE multiply or divide is then
+     correctly rounded. Anything else is rare in this protocol.
+   */
+  if (ndigits >= MAX_MANTISSA_DIGITS || mantissa > MAX_EXACT_MANTISSA
+      || exponent > MAX_EXACT_POW10 || exponent < -MAX_EXACT_POW10)
+    {
+      value = strtod (s, &end);
+      *d = value;
+      return end;
+    }
+  value = (double) mantissa;
+  if (exponent < 0)
+    value /= exactPow10[-exponent];
+  else
+    value *= exactPow10[exponent];
+  *d = negative ? -value : value;
+  return p;
+}
+
+const char *
+usarsimParseInteger (const char *s, int *i)
+{
+  const char *p = s;
+  long value = 0;
+  int negative = 0;
+  int overflow = 0;
+  int digit;
+  char *end;
+
+  if (*p == '-')
+    {
+      negative = 1;
+      p++;
+    }
+  else if (*p == '+')
+    p++;
+  if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+    {
+      /* hex is legal for %i but never sent by USARSim */
+      value = strtol (s, &end, 0);
+      if (end == s)
+	return s;
+      *i = (int) value;
+      return end;
+    }
+  if (!isDigit (*p))
+    return s;
+  for (; isDigit (*p); p++)
+    {
+      digit = *p - '0';
+      /* saturate as strtol does rather than overflow, and keep going
+         so the whole number is consumed */
+      if (overflow || value > (LONG_MAX - digit) / 10)
+	overflow = 1;
+      else
+	value = value * 10 + digit;
+    }
+  if (overflow)
+    value = negative ? LONG_MIN : LONG_MAX;
+  else if (negative)
+    value = -value;
+  *i = (int) value;
+  return p;
+}
+
+template < class T > static const char *
+parseRealList (const char *s, T * out, int max, int *number, int *dropped)
+{
+  const char *p = s;
+  const char *next;
+  double d;
+
+  *number = 0;
+  *dropped = 0;
+  while (1)
+    {
+      while (isBlank (*p))
+	p++;
+      if (*p == '}' || *p == 0)
+	break;
+      next = usarsimParseReal (p, &d);
+      if (next == p)
+	return NULL;
+      if (*number < max)
+	out[(*number)++] = (T) d;
+      else
+	(*dropped)++;
+      p = next;
+      while (isBlank (*p))
+	p++;
+      if (*p == ',')
+	p++;
+    }
+  return p;
+}
+
+const char *
+usarsimParseRealList (const char *s, float *out, int max, int *number,
+		      int *dropped)
+{
+  return parseRealList (s, out, max, number, dropped);
+}
+
+const char *
+usarsimParseRealList (const char *s, double *out, int max, int *number,
+		      int *dropped)
+{
+  return parseRealList (s, out, max, number, dropped);
+}
+
+const char *
+usarsimSkipValue (const char *s)
+{
+  const char *end = strchr (s, '}');
+
+  return end != NULL ? end : s + strlen (s);
+}
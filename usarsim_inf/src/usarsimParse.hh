@@ -0,0 +1,57 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimParse.hh
+  \brief  Number parsing for the USARSim text protocol.
+
+  USARSim always writes numbers in the C locale as an optional sign,
+  digits, an optional fraction and an optional exponent. These routines
+  parse exactly that format without sscanf's format string handling or
+  strtod's locale lookups. Anything they can't convert exactly (more
+  than 19 significant digits, huge exponents, inf/nan) is handed to
+  strtod, so results always match strtod.
+*/
+#ifndef __usarsimParse__
+#define __usarsimParse__
+
+/*!
+  Parse a real number starting at \a s into \a d.
+  \return a pointer just past the number, or \a s if there was none.
+*/
+const char *usarsimParseReal (const char *s, double *d);
+
+/*!
+  Parse a decimal, or 0x-prefixed hexadecimal, integer starting at \a s
+  into \a i.
+  \return a pointer just past the number, or \a s if there was none.
+*/
+const char *usarsimParseInteger (const char *s, int *i);
+
+/*!
+  Parse a comma separated list of reals such as the value of a
+  {Range ...} field. Parsing stops at the closing '}' or the end of
+  the string. The first \a max values go into \a out, and any more are
+  counted in \a dropped.
+  \return a pointer to the character ending the list, or NULL if an
+  entry is not a number. \a number holds how many values were stored.
+*/
+const char *usarsimParseRealList (const char *s, float *out, int max,
+				  int *number, int *dropped);
+const char *usarsimParseRealList (const char *s, double *out, int max,
+				  int *number, int *dropped);
+
+/*!
+  Skip the value of a field such as {Range ...} without converting it.
+  \return a pointer to the closing '}', or to the end of the string if
+  there is none.
+*/
+const char *usarsimSkipValue (const char *s);
+#endif
@@ -0,0 +1,166 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimParseBench.cpp
+  \brief  Times usarsimParseRealList against the sscanf loop it replaced.
+
+  The input is the {Range ...} field of a 6000-sample RangeImager frame.
+  The old loop copies each value out with getValue and converts it with
+  sscanf, as handleSenRangeimager used to. Both must give the same
+  values, or the run fails.
+
+  \code
+  usarsim_parse_bench [frames]
+  \endcode
+*/
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "ulapi.hh"
+#include "usarsimParse.hh"
+
+#define BENCH_SAMPLES 6000
+#define BENCH_FRAMES 200
+
+/* the getValue of the sscanf parser, copying the value into token */
+static char *
+oldGetValue (char *msg, char *token)
+{
+  char *ptr = msg;
+  char *tokenPtr = token;
+
+  while ((isspace (*ptr)) || (*ptr == ',') || (*ptr == '}') || (*ptr == '{'))
+    ptr++;			/* skip over delimiters  */
+
+  /* copy everything until we hit a delimiter  */
+  while (!isspace (*ptr))
+    {
+      if (*ptr == 0)
+	return msg;		/* didn't finish cleanly */
+      if ((*ptr == ',') || (*ptr == '}'))
+	{
+	  break;
+	}
+      /* ok to copy  */
+      *tokenPtr++ = *ptr++;
+    }
+  *tokenPtr = 0;		/* null terminate  */
+  return ptr;
+}
+
+/* the Range loop of the sscanf parser */
+static int
+oldParseRange (char *msg, float *range, int max)
+{
+  char token[256];
+  char *ptr = msg;
+  char *nextptr;
+  int number = 0;
+  float f;
+
+  while (1)
+    {
+      nextptr = oldGetValue (ptr, token);
+      if (nextptr == ptr)
+	{
+	  if (number == 0)
+	    return -1;		// need at least one range value
+	  else
+	    break;
+	}
+      if (sscanf (token, "%f", &f) != 1)
+	return -1;
+      if (number < max)
+	range[number++] = f;
+      ptr = nextptr;
+    }
+  return number;
+}
+
+int
+main (int argc, char *argv[])
+{
+  static float oldRange[BENCH_SAMPLES];
+  static float newRange[BENCH_SAMPLES];
+  std::string field;
+  char value[32];
+  double start, oldTime, newTime;
+  int frames = BENCH_FRAMES;
+  int number = 0, dropped;
+  int i, t;
+
+  if (argc > 1)
+    frames = atoi (argv[1]);
+  if (frames <= 0)
+    {
+      fprintf (stderr, "usage: %s [frames]\n", argv[0]);
+      return 1;
+    }
+
+  /* ranges as USARSim prints them, a few metres with 4 decimals */
+  srand (1);
+  field = "{";
+  for (i = 0; i < BENCH_SAMPLES; i++)
+    {
+      sprintf (value, "%s%.4f", i > 0 ? "," : "",
+	       0.5 + 9.5 * rand () / (double) RAND_MAX);
+      field += value;
+    }
+  field += "}";
+
+  start = ulapi_time ();
+  for (t = 0; t < frames; t++)
+    {
+      std::string msg (field);	// getValue skips past the field's start
+      number = oldParseRange (&msg[1], oldRange, BENCH_SAMPLES);
+    }
+  oldTime = ulapi_time () - start;
+  if (number != BENCH_SAMPLES)
+    {
+      fprintf (stderr, "sscanf loop parsed %d of %d values\n", number,
+	       BENCH_SAMPLES);
+      return 1;
+    }
+
+  start = ulapi_time ();
+  for (t = 0; t < frames; t++)
+    {
+      std::string msg (field);
+      if (usarsimParseRealList (&msg[1], newRange, BENCH_SAMPLES, &number,
+				&dropped) == NULL)
+	number = -1;
+    }
+  newTime = ulapi_time () - start;
+  if (number != BENCH_SAMPLES)
+    {
+      fprintf (stderr, "usarsimParseRealList parsed %d of %d values\n",
+	       number, BENCH_SAMPLES);
+      return 1;
+    }
+
+  for (i = 0; i < BENCH_SAMPLES; i++)
+    {
+      if (oldRange[i] != newRange[i])
+	{
+	  fprintf (stderr, "value %d differs: %.9g from sscanf, %.9g parsed\n",
+		   i, oldRange[i], newRange[i]);
+	  return 1;
+	}
+    }
+
+  printf ("%d frames of %d samples (%u bytes)\n", frames, BENCH_SAMPLES,
+	  (unsigned) field.size ());
+  printf ("  getValue + sscanf:     %8.1f us/frame\n", 1e6 * oldTime / frames);
+  printf ("  usarsimParseRealList:  %8.1f us/frame  (%.1fx)\n",
+	  1e6 * newTime / frames, oldTime / newTime);
+  return 0;
+}
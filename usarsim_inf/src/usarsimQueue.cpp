@@ -0,0 +1,425 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimQueue.cpp
+  \brief  Hands parsed records from the socket thread to the publisher.
+*/
+#include <string.h>
+#include <ros/ros.h>
+#include "ulapi.hh"
+#include "usarsimQueue.hh"
+
+#define PUBLISH_SEM_KEY 2
+
+/*
+  Slot states. Only the producer moves a slot out of FREE or into
+  STALE or WRITING, only the consumer moves it into BUSY or back to
+  FREE, and the READY -> STALE, READY -> BUSY, STALE -> WRITING and
+  STALE -> FREE races are settled with a CAS. WRITING is a stale slot
+  the producer is refilling; the consumer waits for it to be READY.
+*/
+enum
+{
+  SLOT_FREE = 0,
+  SLOT_STALE,
+  SLOT_READY,
+  SLOT_BUSY,
+  SLOT_WRITING
+};
+
+/* true for the periodic records that a newer one makes obsolete */
+static int
+isStatus (const sw_struct * sw)
+{
+  switch (sw->type)
+    {
+    case SW_ROBOT_FIXED:
+      /* BaseMachine and StaticPlatform status, see handleStaBasemachine */
+      return sw->op == SW_DEVICE_STAT;
+    case SW_ROBOT_GROUNDVEHICLE:
+    case SW_ROBOT_AIRBOT:
+      return sw->op == SW_ROBOT_STAT;
+    case SW_ACT:
+      return sw->op == SW_ACT_STAT;
+    case SW_SEN_ENCODER:
+    case SW_SEN_SONAR:
+    case SW_SEN_RANGESCANNER:
+    case SW_SEN_RANGEIMAGER:
+    case SW_SEN_TOUCH:
+    case SW_SEN_CO2:
+    case SW_SEN_INS:
+    case SW_SEN_GPS:
+    case SW_SEN_ODOMETER:
+    case SW_SEN_VICTIM:
+    case SW_SEN_TACHOMETER:
+    case SW_SEN_ACOUSTIC:
+    case SW_SEN_OBJECTSENSOR:
+    case SW_EFF_GRIPPER:
+    case SW_EFF_TOOLCHANGER:
+      /* every sensor and effector uses 1 for its STAT op */
+      return sw->op == 1;
+    default:
+      return 0;
+    }
+}
+
+UsarsimQueue::UsarsimQueue ()
+{
+  slots = NULL;
+  size = mask = 0;
+  head = tail = 0;
+  sem = NULL;
+  pushed = superseded = reused = blocked = published = 0;
+  lastPushed = lastSuperseded = lastReused = lastPublished = 0;
+  maxDepth = 0;
+  statsPeriod = 0;
+  lastStatsTime = 0;
+}
+
+UsarsimQueue::~UsarsimQueue ()
+{
+  if (slots != NULL)
+    {
+      for (unsigned int i = 0; i < size; i++)
+	{
+	  delete[]slots[i].imagerRange;
+	  delete[]slots[i].scannerRange;
+	  delete[]slots[i].objects;
+	  delete[]slots[i].objectNames;
+	  delete[]slots[i].links;
+	  delete[]slots[i].cargoPosition;
+	}
+      delete[]slots;
+    }
+  if (sem != NULL)
+    ulapi_sem_delete (sem);
+}
+
+/*!
+  Allocate a ring of at least \a sizeIn slots, rounded up to a power of
+  two.
+  \return 1 on success, -1 on failure.
+*/
+int
+UsarsimQueue::init (int sizeIn)
+{
+  size = 2;
+  while ((int) size < sizeIn)
+    size *= 2;
+  mask = size - 1;
+  slots = new UsarsimQueueSlot[size];
+  for (unsigned int i = 0; i < size; i++)
+    {
+      slots[i].state = SLOT_FREE;
+      slots[i].source = NULL;
+      slots[i].frame = 0;
+      slots[i].status = 0;
+      slots[i].imagerRange = NULL;
+      slots[i].scannerRange = NULL;
+      slots[i].scannerCapacity = 0;
+      slots[i].objects = NULL;
+      slots[i].objectNames = NULL;
+      slots[i].objectCapacity = 0;
+      slots[i].links = NULL;
+      slots[i].cargoPosition = NULL;
+    }
+  sem = ulapi_sem_new (PUBLISH_SEM_KEY);
+  if (sem == NULL)
+    {
+      ROS_ERROR ("UsarsimQueue: can't create semaphore");
+      return -1;
+    }
+  lastStatsTime = ulapi_time ();
+  return 1;
+}
+
+/* copy \a sw into \a slot, pointing its arrays at the slot's storage */
+void
+UsarsimQueue::copy (UsarsimQueueSlot * slot, const sw_struct * sw, int frame,
+		    int status)
+{
+  int n;
+  int i;
+
+  slot->source = sw;
+  slot->frame = frame;
+  slot->status = status;
+  slot->sw = *sw;
+  switch (sw->type)
+    {
+    case SW_SEN_RANGEIMAGER:
+      if (slot->imagerRange == NULL)
+	slot->imagerRange = new float[SW_SEN_RANGEIMAGER_MAX];
+      n = sw->data.rangeimager.numberperframe;
+      if (n > SW_SEN_RANGEIMAGER_MAX)
+	n = SW_SEN_RANGEIMAGER_MAX;
+      if (n > 0)
+	memcpy (slot->imagerRange, sw->data.rangeimager.range,
+		n * sizeof (float));
+      slot->sw.data.rangeimager.range = slot->imagerRange;
+      break;
+    case SW_SEN_RANGESCANNER:
+      n = sw->data.rangescanner.number;
+      if (n > sw->data.rangescanner.capacity)
+	n = sw->data.rangescanner.capacity;
+      /* scans have no fixed size; grow to the largest seen */
+      if (slot->scannerCapacity < sw->data.rangescanner.capacity)
+	{
+	  delete[]slot->scannerRange;
+	  slot->scannerCapacity = sw->data.rangescanner.capacity;
+	  slot->scannerRange = new float[slot->scannerCapacity];
+	}
+      if (n > 0)
+	memcpy (slot->scannerRange, sw->data.rangescanner.range,
+		n * sizeof (float));
+      slot->sw.data.rangescanner.range = slot->scannerRange;
+      slot->sw.data.rangescanner.capacity = slot->scannerCapacity;
+      break;
+    case SW_SEN_OBJECTSENSOR:
+      n = sw->data.objectsensor.number;
+      if (n > sw->data.objectsensor.capacity)
+	n = sw->data.objectsensor.capacity;
+      if (slot->objectCapacity < sw->data.objectsensor.capacity)
+	{
+	  delete[]slot->objects;
+	  delete[]slot->objectNames;
+	  slot->objectCapacity = sw->data.objectsensor.capacity;
+	  slot->objects = new sw_sen_object_struct[slot->objectCapacity];
+	  slot->objectNames = new std::string[2 * slot->objectCapacity];
+	}
+      if (n > 0)
+	memcpy (slot->objects, sw->data.objectsensor.objects,
+		n * sizeof (sw_sen_object_struct));
+      /* the sensor may empty its name pool before this is published */
+      for (i = 0; i < n; i++)
+	{
+	  slot->objectNames[2 * i] = *slot->objects[i].tag;
+	  slot->objectNames[2 * i + 1] = *slot->objects[i].material_name;
+	  slot->objects[i].tag = &slot->objectNames[2 * i];
+	  slot->objects[i].material_name = &slot->objectNames[2 * i + 1];
+	}
+      slot->sw.data.objectsensor.objects = slot->objects;
+      slot->sw.data.objectsensor.capacity = slot->objectCapacity;
+      slot->sw.data.objectsensor.names = NULL;
+      break;
+    case SW_ACT:
+      if (slot->links == NULL)
+	slot->links = new sw_link_struct[SW_ACT_LINK_MAX];
+      n = sw->data.actuator.number;
+      if (n > SW_ACT_LINK_MAX)
+	n = SW_ACT_LINK_MAX;
+      if (n > 0)
+	memcpy (slot->links, sw->data.actuator.link,
+		n * sizeof (sw_link_struct));
+      slot->sw.data.actuator.link = slot->links;
+      break;
+    case SW_OBJECT_CARGO:
+      if (slot->cargoPosition == NULL)
+	slot->cargoPosition = new sw_pose[SW_MAX_CARGO];
+      n = sw->data.cargo.numCargo;
+      if (n > SW_MAX_CARGO)
+	n = SW_MAX_CARGO;
+      if (n > 0)
+	memcpy (slot->cargoPosition, sw->data.cargo.position,
+		n * sizeof (sw_pose));
+      slot->sw.data.cargo.position = slot->cargoPosition;
+      break;
+    }
+}
+
+/*
+  Mark the queued status record from the same sensor stale, so the
+  publisher skips it and only sees the newer one that is about to be
+  appended. Records that find room are appended in arrival order, so
+  simulator time only goes backwards at the publisher for one put in a
+  reused slot. Coalescing keeps at most one live record
+  per sensor in the ring, but one put in a reused slot may sit behind
+  stale ones, so the search goes on past those. It stops at a
+  configuration record from the same sensor, which is never skipped.
+  \return 1 if a record was made stale, 0 if there is none or the
+  publisher has already started on it.
+*/
+int
+UsarsimQueue::coalesce (const sw_struct * sw, int frame)
+{
+  unsigned int first = tail;
+  unsigned int i;
+  UsarsimQueueSlot *slot;
+
+  for (i = head; i != first; i--)
+    {
+      slot = &slots[(i - 1) & mask];
+      if (slot->source != sw || slot->frame != frame)
+	continue;
+      if (!slot->status)
+	return 0;
+      if (__sync_bool_compare_and_swap (&slot->state, SLOT_READY,
+					SLOT_STALE))
+	return 1;
+    }
+  return 0;
+}
+
+/*
+  With the ring full, put status record \a sw in the newest stale slot
+  instead of waiting for the publisher. The newest is used so the record
+  is published as close to its arrival order as the ring allows, and
+  the publisher may be freeing it, so it is taken with a CAS.
+  \return 1 if a slot was reused, 0 if there is no stale slot.
+*/
+int
+UsarsimQueue::reuse (const sw_struct * sw, int frame)
+{
+  unsigned int first = tail;
+  unsigned int i;
+  UsarsimQueueSlot *slot;
+
+  for (i = head; i != first; i--)
+    {
+      slot = &slots[(i - 1) & mask];
+      if (slot->state != SLOT_STALE
+	  || !__sync_bool_compare_and_swap (&slot->state, SLOT_STALE,
+					    SLOT_WRITING))
+	continue;
+      copy (slot, sw, frame, 1);
+      __sync_synchronize ();
+      slot->state = SLOT_READY;
+      reused++;
+      pushed++;
+      ulapi_sem_give (sem);
+      return 1;
+    }
+  return 0;
+}
+
+/*!
+  Queue a copy of \a sw. Called only from the socket thread. A status
+  record first makes the queued record of its sensor stale, so on a
+  full ring it can take a stale slot; only when there is none, as for
+  other records, does push() wait for the publisher.
+  \return 1, the record is always queued.
+*/
+int
+UsarsimQueue::push (const sw_struct * sw)
+{
+  UsarsimQueueSlot *slot;
+  int status = isStatus (sw);
+  int frame = 0;
+  int d;
+
+  if (sw->type == SW_SEN_RANGEIMAGER)
+    frame = sw->data.rangeimager.frame;
+  if (status && coalesce (sw, frame))
+    superseded++;
+  while (head - tail == size)
+    {
+      if (status && reuse (sw, frame))
+	return 1;
+      blocked++;
+      ulapi_sleep (0.001);
+    }
+  slot = &slots[head & mask];
+  copy (slot, sw, frame, status);
+  slot->state = SLOT_READY;
+  __sync_synchronize ();
+  head++;
+  pushed++;
+  d = head - tail;
+  if (d > maxDepth)
+    maxDepth = d;
+  ulapi_sem_give (sem);
+  return 1;
+}
+
+/*!
+  Block until a record may have been queued. Called only from the
+  publisher thread.
+*/
+int
+UsarsimQueue::wait ()
+{
+  return ULAPI_OK == ulapi_sem_take (sem) ? 1 : -1;
+}
+
+/*!
+  \return the oldest queued record that a newer one hasn't made stale,
+  or NULL if there is none. The record stays valid until pop().
+*/
+sw_struct *
+UsarsimQueue::front ()
+{
+  UsarsimQueueSlot *slot;
+
+  while (tail != head)
+    {
+      __sync_synchronize ();
+      slot = &slots[tail & mask];
+      /* the socket thread may be marking it stale */
+      if (__sync_bool_compare_and_swap (&slot->state, SLOT_READY, SLOT_BUSY))
+	return &slot->sw;
+      /* stale, so skip it, unless the socket thread is refilling it */
+      if (__sync_bool_compare_and_swap (&slot->state, SLOT_STALE, SLOT_FREE))
+	{
+	  __sync_synchronize ();
+	  tail++;
+	}
+    }
+  return NULL;
+}
+
+/*! Release the record returned by front(). */
+void
+UsarsimQueue::pop ()
+{
+  slots[tail & mask].state = SLOT_FREE;
+  __sync_synchronize ();
+  tail++;
+  published++;
+}
+
+void
+UsarsimQueue::setStatsPeriod (double period)
+{
+  statsPeriod = period;
+}
+
+/*!
+  Log the queue statistics for the last period if \a statsPeriod seconds
+  have gone by. A period of 0 disables reporting. Called only from the
+  publisher thread.
+*/
+void
+UsarsimQueue::updateStats ()
+{
+  double now;
+  double elapsed;
+  unsigned long p, s, r;
+
+  if (statsPeriod <= 0)
+    return;
+  now = ulapi_time ();
+  elapsed = now - lastStatsTime;
+  if (elapsed < statsPeriod)
+    return;
+  p = pushed;
+  s = superseded;
+  r = reused;
+  ROS_INFO ("UsarsimQueue: depth %d (max %d of %u), %lu queued, "
+	    "%lu published, %lu superseded, %lu reused, %lu blocked",
+	    depth (), maxDepth, size, p - lastPushed,
+	    published - lastPublished, s - lastSuperseded, r - lastReused,
+	    (unsigned long) blocked);
+  lastPushed = p;
+  lastSuperseded = s;
+  lastReused = r;
+  lastPublished = published;
+  lastStatsTime = now;
+}
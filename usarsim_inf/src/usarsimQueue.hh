@@ -0,0 +1,104 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimQueue.hh
+  \brief  Hands parsed records from the socket thread to the publisher.
+
+  UsarsimQueue is a bounded single-producer/single-consumer ring of
+  sw_struct copies. The socket thread pushes each record it parses and
+  goes straight back to reading; a publisher thread pops records and
+  passes them to ServoInf, so slow TF lookups or serialization no longer
+  hold up the socket.
+
+  Each slot owns its own copy of the variable sized arrays, so a record
+  stays valid after the component it came from is overwritten by the
+  next message.
+
+  Overflow policy: a status record makes the queued, not yet published,
+  status record of the same sensor (and, for range imagers, the same
+  frame) stale and is appended after everything already queued. The
+  publisher skips stale records, so a slow publisher sees only the
+  newest data, in arrival order, and the ring holds at most one live
+  record per sensor. A status record that finds the ring full takes
+  the newest stale slot, which may put it ahead of a few records that
+  arrived before it, so the newest status of a sensor is never
+  dropped. Only when no slot is stale, and always for other
+  records (configuration, geometry), push() waits for room instead.
+*/
+#ifndef __usarsimQueue__
+#define __usarsimQueue__
+#include "simware.hh"
+
+#define USARSIM_QUEUE_DEFAULT_SIZE 64
+
+typedef struct
+{
+  volatile int state;
+  const sw_struct *source;	// component the record was copied from
+  int frame;			// range imager frame, or 0
+  int status;			// a newer record may replace this one
+  sw_struct sw;
+  /* storage for the arrays sw points at, allocated on first use */
+  float *imagerRange;
+  float *scannerRange;
+  int scannerCapacity;
+  sw_sen_object_struct *objects;
+  std::string *objectNames;	// tag and material of each object
+  int objectCapacity;
+  sw_link_struct *links;
+  sw_pose *cargoPosition;
+} UsarsimQueueSlot;
+
+class UsarsimQueue
+{
+public:
+  UsarsimQueue ();
+  ~UsarsimQueue ();
+  int init (int size);
+  /* producer side */
+  int push (const sw_struct * sw);
+  /* consumer side */
+  int wait ();
+  sw_struct *front ();
+  void pop ();
+  int depth ()
+  {
+    return head - tail;
+  }
+  void setStatsPeriod (double period);
+  void updateStats ();
+
+private:
+  UsarsimQueueSlot *slots;
+  unsigned int size;
+  unsigned int mask;
+  volatile unsigned int head;	// next slot to fill, written by the producer
+  volatile unsigned int tail;	// next slot to publish, written by the consumer
+  void *sem;
+  /* statistics */
+  volatile unsigned long pushed;
+  volatile unsigned long superseded;
+  volatile unsigned long reused;
+  volatile unsigned long blocked;
+  volatile int maxDepth;
+  unsigned long published;
+  unsigned long lastPushed;
+  unsigned long lastSuperseded;
+  unsigned long lastReused;
+  unsigned long lastPublished;
+  double statsPeriod;
+  double lastStatsTime;
+  int coalesce (const sw_struct * sw, int frame);
+  int reuse (const sw_struct * sw, int frame);
+  void copy (UsarsimQueueSlot * slot, const sw_struct * sw, int frame,
+	     int status);
+};
+#endif
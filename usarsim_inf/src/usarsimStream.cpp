@@ -0,0 +1,249 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimStream.cpp
+  \brief  Provides line framing for the USARSim socket.
+*/
+#include <stdlib.h>
+#include <string.h>
+#include <ros/ros.h>
+#include "usarsimStream.hh"
+
+UsarsimStream::UsarsimStream ()
+{
+  fd = -1;
+  delim = '\n';
+  buf = NULL;
+  bufSize = 0;
+  head = scan = tail = 0;
+  reads = messages = 0;
+  bytes = 0;
+  lastReads = lastMessages = 0;
+  lastBytes = 0;
+  statsPeriod = 0;
+  lastStatsTime = startTime = 0;
+}
+
+UsarsimStream::~UsarsimStream ()
+{
+  if (buf != NULL)
+    free (buf);
+}
+
+/*!
+  Attach the stream to socket \a fd using a buffer of \a size bytes.
+  \return 1 on success, -1 if the buffer could not be allocated.
+*/
+int
+UsarsimStream::init (ulapi_integer fdIn, size_t size, char delimiter)
+{
+  fd = fdIn;
+  delim = delimiter;
+  if (size < 64)
+    size = 64;
+  buf = (char *) realloc (buf, size);
+  if (buf == NULL)
+    {
+      ROS_ERROR ("UsarsimStream: can't allocate %d byte buffer", (int) size);
+      bufSize = 0;
+      return -1;
+    }
+  bufSize = size;
+  head = scan = tail = 0;
+  startTime = lastStatsTime = ulapi_time ();
+  return 1;
+}
+
+/*
+  Make sure there is free space at the end of the buffer. Lines that
+  have already been handed out are dropped; a trailing partial line is
+  moved to the front only when the free space gets low, and the buffer
+  is doubled if a single line fills all of it.
+*/
+void
+UsarsimStream::makeRoom ()
+{
+  char *newBuf;
+
+  if (head == tail)
+    {
+      head = scan = tail = 0;
+      return;
+    }
+  if (bufSize - tail >= bufSize / 4)
+    return;
+  if (head > 0)
+    {
+      memmove (buf, buf + head, tail - head);
+      scan -= head;
+      tail -= head;
+      head = 0;
+    }
+  if (tail == bufSize)
+    {
+      newBuf = (char *) realloc (buf, 2 * bufSize);
+      if (newBuf == NULL)
+	{
+	  ROS_ERROR ("UsarsimStream: can't grow buffer past %d bytes",
+		     (int) bufSize);
+	  return;
+	}
+      ROS_WARN ("UsarsimStream: line longer than %d bytes, growing buffer",
+		(int) bufSize);
+      buf = newBuf;
+      bufSize *= 2;
+    }
+}
+
+/*!
+  Record every block read from the socket to \a fileName.
+  \return 1 on success, -1 if the file can't be created.
+*/
+int
+UsarsimStream::captureTo (const char *fileName)
+{
+  return capture.openWrite (fileName);
+}
+
+/*!
+  Read from the capture in \a fileName instead of the socket, paced at
+  \a rate times the recorded speed, or as fast as possible if \a rate
+  is 0. The statistics restart with the replay.
+  \return 1 on success, -1 if the file can't be opened.
+*/
+int
+UsarsimStream::replayFrom (const char *fileName, double rate)
+{
+  if (capture.openRead (fileName, rate) < 0)
+    return -1;
+  reads = messages = 0;
+  bytes = 0;
+  lastReads = lastMessages = 0;
+  lastBytes = 0;
+  startTime = lastStatsTime = ulapi_time ();
+  return 1;
+}
+
+/*!
+  Do a single read from the socket, or the replay, into the free part
+  of the buffer.
+  \return the number of bytes read, 0 on end of file and -1 on error.
+*/
+int
+UsarsimStream::fill ()
+{
+  int nchars;
+
+  makeRoom ();
+  if (tail == bufSize)
+    return -1;
+  if (capture.isReplay ())
+    nchars = capture.read (buf + tail, bufSize - tail);
+  else
+    nchars = ulapi_socket_read (fd, buf + tail, bufSize - tail);
+  reads++;
+  if (nchars <= 0)
+    return nchars;
+  if (capture.isOpen () && !capture.isReplay ())
+    capture.write (buf + tail, nchars);
+  tail += nchars;
+  bytes += nchars;
+  return nchars;
+}
+
+/*!
+  \return the next complete line, null terminated in place of the
+  delimiter, or NULL if no complete line is buffered. The pointer is
+  valid until the next call to fill().
+*/
+char *
+UsarsimStream::nextLine ()
+{
+  char *line;
+  char *end;
+
+  end = (char *) memchr (buf + scan, delim, tail - scan);
+  if (end == NULL)
+    {
+      scan = tail;
+      return NULL;
+    }
+  *end = 0;
+  line = buf + head;
+  head = scan = (end - buf) + 1;
+  messages++;
+  return line;
+}
+
+void
+UsarsimStream::setStatsPeriod (double period)
+{
+  statsPeriod = period;
+}
+
+double
+UsarsimStream::syscallsPerMessage ()
+{
+  if (messages == 0)
+    return 0;
+  return (double) reads / (double) messages;
+}
+
+double
+UsarsimStream::bytesPerSecond ()
+{
+  double elapsed = ulapi_time () - startTime;
+
+  if (elapsed <= 0)
+    return 0;
+  return (double) bytes / elapsed;
+}
+
+/*!
+  Log the read statistics for the last period if \a statsPeriod seconds
+  have gone by. A period of 0 disables reporting.
+*/
+void
+UsarsimStream::updateStats ()
+{
+  double now;
+  double elapsed;
+  unsigned long periodMessages;
+
+  if (statsPeriod <= 0)
+    return;
+  now = ulapi_time ();
+  elapsed = now - lastStatsTime;
+  if (elapsed < statsPeriod)
+    return;
+  periodMessages = messages - lastMessages;
+  ROS_INFO ("UsarsimStream: %lu msgs, %.2f reads/msg, %.1f msgs/s, %.1f KB/s",
+	    periodMessages,
+	    periodMessages ? (double) (reads - lastReads) / periodMessages : 0.,
+	    periodMessages / elapsed,
+	    (double) (bytes - lastBytes) / elapsed / 1024.);
+  lastReads = reads;
+  lastMessages = messages;
+  lastBytes = bytes;
+  lastStatsTime = now;
+}
+
+/*! Log the totals since the stream started, e.g. at the end of a replay. */
+void
+UsarsimStream::logTotals ()
+{
+  double elapsed = ulapi_time () - startTime;
+
+  ROS_INFO ("UsarsimStream: %lu msgs, %.2f MB in %.3f s: %.1f msgs/s, "
+	    "%.2f MB/s", messages, (double) bytes / (1024. * 1024.), elapsed,
+	    elapsed > 0 ? messages / elapsed : 0.,
+	    elapsed > 0 ? (double) bytes / (1024. * 1024.) / elapsed : 0.);
+}
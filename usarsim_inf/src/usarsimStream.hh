@@ -0,0 +1,81 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimStream.hh
+  \brief  Provides line framing for the USARSim socket.
+
+  USARSim sends one message per line. UsarsimStream reads the socket in
+  large blocks into a reusable buffer and hands out each complete line in
+  place, so a message costs at most one read() instead of one per 8 bytes.
+  The buffer only moves data when a partial line has to be shifted back
+  to the front, and grows if a single line is larger than the buffer.
+
+  The stream can also record everything it reads to a capture file, or
+  read from a capture instead of the socket (see UsarsimCapture).
+*/
+#ifndef __usarsimStream__
+#define __usarsimStream__
+#include <stddef.h>
+#include "ulapi.hh"
+#include "usarsimCapture.hh"
+
+#define USARSIM_STREAM_DEFAULT_SIZE (256 * 1024)
+
+class UsarsimStream
+{
+public:
+  UsarsimStream ();
+  ~UsarsimStream ();
+  int init (ulapi_integer fd, size_t size, char delimiter);
+  int fill ();
+  char *nextLine ();
+  int captureTo (const char *fileName);
+  int replayFrom (const char *fileName, double rate);
+  bool isReplay ()
+  {
+    return capture.isReplay ();
+  }
+  void setStatsPeriod (double period);
+  void updateStats ();
+  void logTotals ();
+  double syscallsPerMessage ();
+  double bytesPerSecond ();
+  unsigned long getMessages ()
+  {
+    return messages;
+  }
+  unsigned long long getBytes ()
+  {
+    return bytes;
+  }
+
+private:
+  ulapi_integer fd;
+  UsarsimCapture capture;
+  char delim;
+  char *buf;
+  size_t bufSize;
+  size_t head;			// start of the first unconsumed line
+  size_t scan;			// everything before this has been searched
+  size_t tail;			// end of valid data
+  /* statistics */
+  unsigned long reads;
+  unsigned long messages;
+  unsigned long long bytes;
+  unsigned long lastReads;
+  unsigned long lastMessages;
+  unsigned long long lastBytes;
+  double statsPeriod;
+  double lastStatsTime;
+  double startTime;
+  void makeRoom ();
+};
+#endif
@@ -0,0 +1,105 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimToken.hh
+  \brief  A non-copying view of one token of a USARSim message.
+
+  Tokens point straight into the receive buffer and are not null
+  terminated, so they are only valid while the message they came from
+  is. Use str() or copy() when the text has to outlive the message.
+*/
+#ifndef __usarsimToken__
+#define __usarsimToken__
+#include <stddef.h>
+#include <string.h>
+#include <strings.h>
+#include <string>
+#include "usarsimParse.hh"
+#include "usarsimKeyword.hh"
+
+class UsarsimToken
+{
+public:
+  const char *ptr;
+  size_t len;
+
+  UsarsimToken ()
+  {
+    ptr = "";
+    len = 0;
+  }
+  void set (const char *start, const char *end)
+  {
+    ptr = start;
+    len = end - start;
+  }
+  /* exact match against a null terminated string */
+  bool is (const char *s) const
+  {
+    return strncmp (ptr, s, len) == 0 && s[len] == 0;
+  }
+  /* case insensitive match against a null terminated string */
+  bool isCase (const char *s) const
+  {
+    return strncasecmp (ptr, s, len) == 0 && s[len] == 0;
+  }
+  /* true if the token begins with \a s */
+  bool startsWith (const char *s) const
+  {
+    size_t n = strlen (s);
+    return n <= len && strncmp (ptr, s, n) == 0;
+  }
+  /* the protocol word this token spells, for switch dispatch */
+  UsarsimKeyword keyword () const
+  {
+    return usarsimKeyword (ptr, len);
+  }
+  std::string str () const
+  {
+    return std::string (ptr, len);
+  }
+  /* copy into \a dst, truncating and always null terminating */
+  void copy (char *dst, size_t size) const
+  {
+    size_t n = len < size ? len : size - 1;
+    memcpy (dst, ptr, n);
+    dst[n] = 0;
+  }
+  /* numeric conversions stop at the token delimiter, so they never
+     read past the end of the token */
+  bool toInteger (int *i) const
+  {
+    int v;
+    const char *end = usarsimParseInteger (ptr, &v);
+    if (end == ptr || end > ptr + len)
+      return false;
+    *i = v;
+    return true;
+  }
+  bool toReal (double *d) const
+  {
+    double v;
+    const char *end = usarsimParseReal (ptr, &v);
+    if (end == ptr || end > ptr + len)
+      return false;
+    *d = v;
+    return true;
+  }
+  bool toReal (float *f) const
+  {
+    double d;
+    if (!toReal (&d))
+      return false;
+    *f = (float) d;
+    return true;
+  }
+};
+#endif
@@ -0,0 +1,221 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimWriter.cpp
+  \brief  Writes commands to the USARSim socket from a single thread.
+*/
+#include <errno.h>
+#include <string.h>
+#include <sys/uio.h>		/* writev(), struct iovec */
+#include <ros/ros.h>
+#include "usarsimWriter.hh"
+
+#define WRITER_MUTEX_KEY 3
+#define WRITER_SEM_KEY 4
+/* iovecs per writev, well under any system's IOV_MAX */
+#define WRITER_MAX_IOV 64
+
+UsarsimWriter::UsarsimWriter ()
+{
+  fd = -1;
+  mutex = NULL;
+  sem = NULL;
+  pendingCount = writingCount = 0;
+  commands = coalesced = writes = 0;
+  bytes = 0;
+  lastCommands = lastCoalesced = lastWrites = 0;
+  lastBytes = 0;
+  statsPeriod = 0;
+  lastStatsTime = 0;
+}
+
+UsarsimWriter::~UsarsimWriter ()
+{
+  if (mutex != NULL)
+    ulapi_mutex_delete (mutex);
+  if (sem != NULL)
+    ulapi_sem_delete (sem);
+}
+
+/*!
+  Write commands to socket \a fdIn. run() must be started on its own
+  thread for anything to be written.
+  \return 1 on success, -1 on failure.
+*/
+int
+UsarsimWriter::init (ulapi_integer fdIn)
+{
+  fd = fdIn;
+  mutex = ulapi_mutex_new (WRITER_MUTEX_KEY);
+  sem = ulapi_sem_new (WRITER_SEM_KEY);
+  if (mutex == NULL || sem == NULL)
+    {
+      ROS_ERROR ("UsarsimWriter: can't create mutex or semaphore");
+      return -1;
+    }
+  lastStatsTime = ulapi_time ();
+  return 1;
+}
+
+void
+UsarsimWriter::setStatsPeriod (double period)
+{
+  statsPeriod = period;
+}
+
+/*!
+  Queue \a text, a complete command with its line ending, for writing.
+  If \a key is not NULL and a command with the same key is still
+  waiting, that command is replaced instead. Safe to call from any
+  thread.
+  \return 1.
+*/
+int
+UsarsimWriter::send (const char *key, const char *text)
+{
+  size_t i;
+  int wake;
+
+  ROS_DEBUG ("Sending: %s", text);
+  ulapi_mutex_take (mutex);
+  commands++;
+  if (key != NULL)
+    {
+      for (i = 0; i < pendingCount; i++)
+	{
+	  if (pending[i].key == key)
+	    {
+	      pending[i].text = text;
+	      coalesced++;
+	      ulapi_mutex_give (mutex);
+	      return 1;
+	    }
+	}
+    }
+  if (pendingCount == pending.size ())
+    pending.resize (pendingCount + 1);
+  if (key != NULL)
+    pending[pendingCount].key = key;
+  else
+    pending[pendingCount].key.clear ();
+  pending[pendingCount].text = text;
+  wake = pendingCount == 0;
+  pendingCount++;
+  ulapi_mutex_give (mutex);
+  if (wake)
+    ulapi_sem_give (sem);
+  return 1;
+}
+
+/*
+  Write every command in the writing list, WRITER_MAX_IOV at a time,
+  finishing any partial writes.
+  \return 1 on success, -1 on a socket error.
+*/
+int
+UsarsimWriter::writeAll ()
+{
+  struct iovec iov[WRITER_MAX_IOV];
+  size_t next = 0;
+  int n;
+  ssize_t written;
+
+  while (next < writingCount)
+    {
+      for (n = 0; n < WRITER_MAX_IOV && next + n < writingCount; n++)
+	{
+	  iov[n].iov_base = (void *) writing[next + n].text.data ();
+	  iov[n].iov_len = writing[next + n].text.size ();
+	}
+      next += n;
+      while (n > 0)
+	{
+	  written = writev (fd, iov, n);
+	  if (written < 0)
+	    {
+	      if (errno == EINTR)
+		continue;
+	      ROS_ERROR ("UsarsimWriter: write failed: %s", strerror (errno));
+	      return -1;
+	    }
+	  writes++;
+	  bytes += written;
+	  /* skip what went out and retry the rest */
+	  while (n > 0 && (size_t) written >= iov[0].iov_len)
+	    {
+	      written -= iov[0].iov_len;
+	      memmove (iov, iov + 1, --n * sizeof (struct iovec));
+	    }
+	  if (n > 0)
+	    {
+	      iov[0].iov_base = (char *) iov[0].iov_base + written;
+	      iov[0].iov_len -= written;
+	    }
+	}
+    }
+  return 1;
+}
+
+/*!
+  Write queued commands until the socket fails. This is the body of the
+  writer thread; it sleeps while nothing is pending.
+  \return -1 on a socket error.
+*/
+int
+UsarsimWriter::run ()
+{
+  while (1)
+    {
+      if (ULAPI_OK != ulapi_sem_take (sem))
+	return -1;
+      ulapi_mutex_take (mutex);
+      /* take everything pending; new sends go to the emptied list */
+      pending.swap (writing);
+      writingCount = pendingCount;
+      pendingCount = 0;
+      ulapi_mutex_give (mutex);
+      if (writeAll () < 0)
+	return -1;
+      updateStats ();
+    }
+  return 1;
+}
+
+/*
+  Log the write statistics for the last period if \a statsPeriod seconds
+  have gone by. A period of 0 disables reporting.
+*/
+void
+UsarsimWriter::updateStats ()
+{
+  double now;
+  double elapsed;
+  unsigned long c, s;
+
+  if (statsPeriod <= 0)
+    return;
+  now = ulapi_time ();
+  elapsed = now - lastStatsTime;
+  if (elapsed < statsPeriod)
+    return;
+  ulapi_mutex_take (mutex);
+  c = commands;
+  s = coalesced;
+  ulapi_mutex_give (mutex);
+  ROS_INFO ("UsarsimWriter: %lu commands, %lu coalesced, %lu writes, "
+	    "%.1f KB/s", c - lastCommands, s - lastCoalesced,
+	    writes - lastWrites, (double) (bytes - lastBytes) / elapsed / 1024.);
+  lastCommands = c;
+  lastCoalesced = s;
+  lastWrites = writes;
+  lastBytes = bytes;
+  lastStatsTime = now;
+}
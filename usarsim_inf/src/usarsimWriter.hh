@@ -0,0 +1,70 @@
+/*****************************************************************************
+  DISCLAIMER:
+  This software was produced by the National Institute of Standards
+  and Technology (NIST), an agency of the U.S. government, and by statute is
+  not subject to copyright in the United States.  Recipients of this software
+  assume all responsibility associated with its operation, modification,
+  maintenance, and subsequent redistribution.
+
+  See NIST Administration Manual 4.09.07 b and Appendix I.
+*****************************************************************************/
+/*!
+  \file   usarsimWriter.hh
+  \brief  Writes commands to the USARSim socket from a single thread.
+
+  Any thread may queue a command with send(); a dedicated writer thread
+  takes everything pending and writes it with one writev(). Callers
+  never block on the socket.
+
+  Commands sent with a key are latest-wins: if a command with the same
+  key is still waiting to be written, its text is replaced in place, so
+  a flood of cmd_vel messages turns into one Drive per write instead of
+  a growing backlog. Commands without a key (the handshake, INIT) are
+  always written, in order.
+*/
+#ifndef __usarsimWriter__
+#define __usarsimWriter__
+#include <string>
+#include <vector>
+#include "ulapi.hh"
+
+typedef struct
+{
+  std::string key;
+  std::string text;
+} UsarsimCommand;
+
+class UsarsimWriter
+{
+public:
+  UsarsimWriter ();
+  ~UsarsimWriter ();
+  int init (ulapi_integer fd);
+  int send (const char *key, const char *text);
+  int run ();
+  void setStatsPeriod (double period);
+
+private:
+  ulapi_integer fd;
+  void *mutex;			// guards pending and pendingCount
+  void *sem;			// given when pending goes from empty to not
+  /* entries past the count are kept for their string storage */
+  std::vector < UsarsimCommand > pending;
+  size_t pendingCount;
+  std::vector < UsarsimCommand > writing;
+  size_t writingCount;
+  /* statistics */
+  unsigned long commands;
+  unsigned long coalesced;
+  unsigned long writes;
+  unsigned long long bytes;
+  unsigned long lastCommands;
+  unsigned long lastCoalesced;
+  unsigned long lastWrites;
+  unsigned long long lastBytes;
+  double statsPeriod;
+  double lastStatsTime;
+  int writeAll ();
+  void updateStats ();
+};
+#endif
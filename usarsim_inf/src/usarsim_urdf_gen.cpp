@@ -94,6 +94,7 @@ main (int argc, char **argv)
   unsigned int i;
   char* visualsPath = NULL;
   char* collisionsPath = NULL;
+  int err;
 
   // init ros
   ros::init (argc, argv, "usarsim");
@@ -131,6 +132,10 @@ main (int argc, char **argv)
   //make sure ROS publishes the TF tree for robot models so the urdf can be generated.
   servo->setBuildingTFTree ();
 
+  // publish from this thread, so nothing is still updating the servo
+  // state while the urdf file is written
+  usarsim->setSynchronous ();
+
   // initialize the USARSim interface wrapper
   usarsim->init (servo);
 
@@ -140,7 +145,10 @@ main (int argc, char **argv)
   //ROS_INFO ("Waiting 5 sec. for system to stabilize\n");
   while ((usarsim->getNH ())->ok ())
   {
-    if (usarsim->msgIn () != 1)
+    err = usarsim->msgIn ();
+    if (err == 0)
+      break;			// end of a replay
+    if (err != 1)
     {
       ROS_ERROR ("Error from usarsimInf");
     }